@@ -54,8 +54,10 @@ std::shared_ptr<ScriptEmbedderNS::ScriptEmbedder> createEmbedder()
     conf.addScript(ScriptEntry(0u, "scripts/hello.qs", "QtScript"));
     conf.addScript(ScriptEntry(1u, "scripts/printTime.qs", "QtScript", true));
     conf.addScript(ScriptEntry(2u, "scripts/printMyStruct.qs", "QtScript"));
-    if (!conf.isValid()){
-        qDebug() << conf.errorString();
+    conf.addScript(ScriptEntry(3u, "scripts/sum.qs", "QtScript", true, 0u, "sum"));
+    ValidationReport report = conf.validate();
+    if (!report.isValid()){
+        qDebug() << report.errorString();
         return std::shared_ptr<ScriptEmbedder>(nullptr);
     }
 
@@ -88,7 +90,9 @@ int main(int argc, char* argv[])
     embedder->execute(0);
     embedder->execute(1);
     embedder->execute(2, QStringList{"12", "3.14", "a"});
-    embedder->execute(3); // No such script.
+    embedder->execute(3, QStringList{"1", "2", "3"});
+    embedder->execute(3, QStringList{"4", "5"}); // Script is not re-evaluated.
+    embedder->execute(4); // No such script.
 
     qDebug() << "Press ^C to exit.";
     return a.exec();
@@ -14,7 +14,8 @@ INCLUDEPATH += \
 HEADERS += \
     qtscriptplugin.hh \
     qtscriptinterpreter.hh \
-    qtscriptapiadapter.hh
+    qtscriptapiadapter.hh \
+    qtscriptbinding.hh
 
 SOURCES += \
     qtscriptplugin.cc \
@@ -6,55 +6,24 @@
 
 #include "qtscriptapiadapter.hh"
 
-QtScriptApiAdapter::QtScriptApiAdapter(MyScriptAPI* api, QScriptEngine* engine, QObject* parent):
-    QObject(parent), api_(api), eng_(engine)
+QtScriptApiAdapter::QtScriptApiAdapter(MyScriptAPI* api, QScriptEngine* engine):
+    binding_(engine, api)
 {
-    Q_ASSERT(api_ != nullptr);
-    Q_ASSERT(eng_ != nullptr);
-}
-
-QtScriptApiAdapter::~QtScriptApiAdapter()
-{
-}
-
-void QtScriptApiAdapter::sayHello()
-{
-    api_->sayHello();
-}
-
-void QtScriptApiAdapter::saySomething(const QString& msg, int repeat)
-{
-    api_->saySomething(msg, repeat);
-}
+    Q_ASSERT(api != nullptr);
+    Q_ASSERT(engine != nullptr);
 
-QDateTime QtScriptApiAdapter::timeNow()
-{
-    return api_->timeNow();
+    // Adapter methods for MyAPI
+    binding_.method("sayHello", &MyScriptAPI::sayHello)
+            .method("saySomething", &MyScriptAPI::saySomething)
+            .method("timeNow", &MyScriptAPI::timeNow)
+            .method("doStuffToMyStruct", &MyScriptAPI::doStuffToMyStruct);
 }
 
-QScriptValue QtScriptApiAdapter::doStuffToMyStruct(const QScriptValue& myStruct)
-{
-    CustomStruct cs;
-    fromScriptValue(myStruct, cs);
-    CustomStruct rv = api_->doStuffToMyStruct(cs);
-    return toScriptValue(eng_, rv);
-}
-
-
-QScriptValue toScriptValue(QScriptEngine* eng, const CustomStruct& cs)
+QtScriptApiAdapter::~QtScriptApiAdapter()
 {
-    Q_ASSERT(eng != nullptr);
-    QScriptValue val = eng->newObject();
-    val.setProperty("foo", cs.foo);
-    val.setProperty("bar", cs.bar);
-    val.setProperty("baz", cs.baz);
-    return val;
 }
 
-
-void fromScriptValue(const QScriptValue& value, CustomStruct& cs)
+QScriptValue QtScriptApiAdapter::object() const
 {
-    cs.foo = value.property("foo").toInt32();
-    cs.bar = (double)(value.property("bar").toNumber());
-    cs.baz = value.property("baz").toString().toStdString().at(0);
+    return binding_.object();
 }
@@ -7,62 +7,48 @@
 #ifndef QTSCRIPTAPIADAPTER_HH
 #define QTSCRIPTAPIADAPTER_HH
 
-#include <QObject>
 #include <QDateTime>
 #include <QScriptValue>
 #include <QScriptEngine>
 #include "myscriptapi.hh"
+#include "qtscriptbinding.hh"
+
+
+// Fields of CustomStruct visible to scripts.
+QTSCRIPT_BEGIN_STRUCT(CustomStruct)
+    QTSCRIPT_FIELD(foo)
+    QTSCRIPT_FIELD(bar)
+    QTSCRIPT_FIELD(baz)
+QTSCRIPT_END_STRUCT()
+
 
 /**
  * @brief Adapts the MyScriptAPI interface suitable for QtScript.
  */
-class QtScriptApiAdapter : public QObject
+class QtScriptApiAdapter
 {
-    Q_OBJECT
-
 public:
 
     /**
-     * @brief Constructor.
+     * @brief Constructor. Binds MyScriptAPI methods into a script object.
      * @param api API object.
      * @param engine QScriptEngine.
      * @pre api != nullptr, engine != nullptr.
      */
-    QtScriptApiAdapter(MyScriptAPI* api,
-                       QScriptEngine* engine,
-                       QObject* parent = 0);
+    QtScriptApiAdapter(MyScriptAPI* api, QScriptEngine* engine);
 
     ~QtScriptApiAdapter();
 
-public slots:
-
-    // Adapter methods for MyAPI
-    void sayHello();
-    void saySomething(const QString& msg, int repeat);
-    QDateTime timeNow();
-    QScriptValue doStuffToMyStruct(const QScriptValue& myStruct);
+    /**
+     * @brief Get the script object representing MyScriptAPI.
+     * @return Object having API methods as its properties.
+     */
+    QScriptValue object() const;
 
 
 private:
 
-    MyScriptAPI* api_;
-    QScriptEngine* eng_;
+    QtScriptBinding::ApiBinding<MyScriptAPI> binding_;
 };
 
-
-/**
- * @brief Converts CustomStruct to QScriptValue.
- * @param eng QScriptEngine required for creating QScriptValue.
- * @param cs Source object
- * @return QScriptValue representing CustomStruct.
- */
-QScriptValue toScriptValue(QScriptEngine* eng, const CustomStruct& cs);
-
-/**
- * @brief Convert QScriptValue to CustomStruct.
- * @param value Source value.
- * @param cs Target object,
- */
-void fromScriptValue(const QScriptValue& value, CustomStruct& cs);
-
 #endif // QTSCRIPTAPIADAPTER_HH
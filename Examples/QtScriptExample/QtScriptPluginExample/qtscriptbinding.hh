@@ -0,0 +1,450 @@
+/**
+ * @file
+ * @brief Defines templates for binding C++ API methods and structs to
+ * QtScript. Struct fields and API methods are described once, and the
+ * required conversions are generated at compile time. Property names are
+ * resolved into QScriptString handles when binding is created, so
+ * conversions do not hash property name strings.
+ * @author Perttu Paarlahti 2016.
+ */
+
+#ifndef QTSCRIPTBINDING_HH
+#define QTSCRIPTBINDING_HH
+
+#include <QScriptEngine>
+#include <QScriptContext>
+#include <QScriptString>
+#include <QScriptValue>
+#include <QString>
+#include <memory>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace QtScriptBinding
+{
+
+/**
+ * @brief Describes fields of a struct. Specialize using QTSCRIPT_BEGIN_STRUCT,
+ * QTSCRIPT_FIELD and QTSCRIPT_END_STRUCT macros. Structs that are not
+ * described are converted as plain values.
+ */
+template <typename T>
+struct StructFields
+{
+    static const bool described = false;
+};
+
+
+/**
+ * @brief Conversions for plain values. Default implementation uses types
+ * known to Qt meta type system. Specialize for other types.
+ */
+template <typename T>
+struct ValueTraits
+{
+    static QScriptValue toScriptValue(QScriptEngine* eng, const T& value)
+    {
+        return eng->toScriptValue(value);
+    }
+
+    static T fromScriptValue(const QScriptValue& value)
+    {
+        return qscriptvalue_cast<T>(value);
+    }
+};
+
+
+template <>
+struct ValueTraits<int>
+{
+    static QScriptValue toScriptValue(QScriptEngine*, int value)
+    {
+        return QScriptValue(value);
+    }
+
+    static int fromScriptValue(const QScriptValue& value)
+    {
+        return value.toInt32();
+    }
+};
+
+
+template <>
+struct ValueTraits<double>
+{
+    static QScriptValue toScriptValue(QScriptEngine*, double value)
+    {
+        return QScriptValue(value);
+    }
+
+    static double fromScriptValue(const QScriptValue& value)
+    {
+        return (double)(value.toNumber());
+    }
+};
+
+
+template <>
+struct ValueTraits<bool>
+{
+    static QScriptValue toScriptValue(QScriptEngine*, bool value)
+    {
+        return QScriptValue(value);
+    }
+
+    static bool fromScriptValue(const QScriptValue& value)
+    {
+        return value.toBool();
+    }
+};
+
+
+template <>
+struct ValueTraits<QString>
+{
+    static QScriptValue toScriptValue(QScriptEngine*, const QString& value)
+    {
+        return QScriptValue(value);
+    }
+
+    static QString fromScriptValue(const QScriptValue& value)
+    {
+        return value.toString();
+    }
+};
+
+
+/**
+ * @brief Characters are represented as one-character strings in scripts.
+ */
+template <>
+struct ValueTraits<char>
+{
+    static QScriptValue toScriptValue(QScriptEngine*, char value)
+    {
+        return QScriptValue(QString(QChar::fromLatin1(value)));
+    }
+
+    static char fromScriptValue(const QScriptValue& value)
+    {
+        QString str = value.toString();
+        return str.isEmpty() ? '\0' : str.at(0).toLatin1();
+    }
+};
+
+
+/**
+ * @brief Converts values of type T between C++ and QtScript.
+ * Plain values are converted using ValueTraits.
+ */
+template <typename T, bool isStruct = StructFields<T>::described>
+class Converter
+{
+public:
+
+    explicit Converter(QScriptEngine* eng) : eng_(eng) {}
+
+    QScriptValue toScriptValue(const T& value) const
+    {
+        return ValueTraits<T>::toScriptValue(eng_, value);
+    }
+
+    T fromScriptValue(const QScriptValue& value) const
+    {
+        return ValueTraits<T>::fromScriptValue(value);
+    }
+
+private:
+
+    QScriptEngine* eng_;
+};
+
+
+/**
+ * @brief Converts described structs between C++ and QtScript objects.
+ * Property handles are created once in constructor. Fields are converted
+ * using ValueTraits.
+ */
+template <typename T>
+class Converter<T, true>
+{
+public:
+
+    explicit Converter(QScriptEngine* eng) : eng_(eng), names_()
+    {
+        NameCollector collector = {eng_, &names_};
+        StructFields<T>::describe(collector);
+    }
+
+    QScriptValue toScriptValue(const T& value) const
+    {
+        QScriptValue obj = eng_->newObject();
+        Writer writer = {eng_, &obj, &value, names_.data()};
+        StructFields<T>::describe(writer);
+        return obj;
+    }
+
+    T fromScriptValue(const QScriptValue& obj) const
+    {
+        T value = T();
+        Reader reader = {&obj, &value, names_.data()};
+        StructFields<T>::describe(reader);
+        return value;
+    }
+
+private:
+
+    struct NameCollector
+    {
+        QScriptEngine* eng;
+        std::vector<QScriptString>* names;
+
+        template <typename F>
+        void operator()(const char* name, F T::*)
+        {
+            names->push_back(eng->toStringHandle(QString::fromLatin1(name)));
+        }
+    };
+
+    struct Writer
+    {
+        QScriptEngine* eng;
+        QScriptValue* obj;
+        const T* value;
+        const QScriptString* name;
+
+        template <typename F>
+        void operator()(const char*, F T::* member)
+        {
+            obj->setProperty(*name++, ValueTraits<F>::toScriptValue(eng, value->*member));
+        }
+    };
+
+    struct Reader
+    {
+        const QScriptValue* obj;
+        T* value;
+        const QScriptString* name;
+
+        template <typename F>
+        void operator()(const char*, F T::* member)
+        {
+            value->*member = ValueTraits<F>::fromScriptValue(obj->property(*name++));
+        }
+    };
+
+    QScriptEngine* eng_;
+    std::vector<QScriptString> names_;
+};
+
+
+// Compile-time index sequences for unpacking method arguments (C++11).
+template <std::size_t... I>
+struct IndexSequence {};
+
+template <std::size_t N, std::size_t... I>
+struct MakeIndexSequence : MakeIndexSequence<N-1, N-1, I...> {};
+
+template <std::size_t... I>
+struct MakeIndexSequence<0, I...>
+{
+    typedef IndexSequence<I...> type;
+};
+
+template <typename T>
+using Plain = typename std::decay<T>::type;
+
+
+/**
+ * @brief Calls the API method and converts its return value.
+ */
+template <typename R>
+class ResultConverter
+{
+public:
+
+    explicit ResultConverter(QScriptEngine* eng) : conv_(eng) {}
+
+    template <typename Api, typename Fn, typename... Values>
+    QScriptValue call(Api* api, Fn fn, Values&&... values) const
+    {
+        return conv_.toScriptValue((api->*fn)(std::forward<Values>(values)...));
+    }
+
+private:
+
+    Converter<Plain<R> > conv_;
+};
+
+
+template <>
+class ResultConverter<void>
+{
+public:
+
+    explicit ResultConverter(QScriptEngine*) {}
+
+    template <typename Api, typename Fn, typename... Values>
+    QScriptValue call(Api* api, Fn fn, Values&&... values) const
+    {
+        (api->*fn)(std::forward<Values>(values)...);
+        return QScriptValue(QScriptValue::UndefinedValue);
+    }
+};
+
+
+/**
+ * @brief Base class for bound methods, allowing ownership in one container.
+ */
+class MethodBase
+{
+public:
+    virtual ~MethodBase() {}
+};
+
+
+/**
+ * @brief Native QtScript function forwarding calls to an API method.
+ */
+template <typename Api, typename Fn, typename R, typename... Args>
+class Method : public MethodBase
+{
+public:
+
+    Method(QScriptEngine* eng, Api* api, Fn fn) :
+        MethodBase(), api_(api), fn_(fn),
+        args_(Converter<Plain<Args> >(eng)...), result_(eng)
+    {
+    }
+
+    virtual ~Method() {}
+
+    /**
+     * @brief QScriptEngine::FunctionWithArgSignature compatible entry point.
+     * @param data Pointer to the Method object.
+     */
+    static QScriptValue invoke(QScriptContext* ctx, QScriptEngine*, void* data)
+    {
+        Method* self = static_cast<Method*>(data);
+        if (ctx->argumentCount() < (int)sizeof...(Args)){
+            return ctx->throwError(QScriptContext::TypeError,
+                                   QString("Expected %1 arguments.").arg(sizeof...(Args)));
+        }
+        return self->call(ctx, typename MakeIndexSequence<sizeof...(Args)>::type());
+    }
+
+private:
+
+    template <std::size_t... I>
+    QScriptValue call(QScriptContext* ctx, IndexSequence<I...>)
+    {
+        return result_.call(api_, fn_, std::get<I>(args_).fromScriptValue(ctx->argument(I))...);
+    }
+
+    Api* api_;
+    Fn fn_;
+    std::tuple<Converter<Plain<Args> >...> args_;
+    ResultConverter<R> result_;
+};
+
+
+/**
+ * @brief Binds methods of an API object into a QtScript object.
+ * Binding must outlive the script engine's use of bound functions.
+ */
+template <typename Api>
+class ApiBinding
+{
+public:
+
+    /**
+     * @brief Constructor.
+     * @param eng Script engine.
+     * @param api API object whose methods are bound.
+     * @pre eng != nullptr, api != nullptr.
+     */
+    ApiBinding(QScriptEngine* eng, Api* api) :
+        eng_(eng), api_(api), object_(eng->newObject()), methods_()
+    {
+    }
+
+    /**
+     * @brief Bind method to the script object.
+     * @param name Method name seen by scripts.
+     * @param fn Bound method.
+     * @return This object, allowing chained calls.
+     */
+    template <typename R, typename... Args>
+    ApiBinding& method(const char* name, R (Api::*fn)(Args...))
+    {
+        return this->add<R (Api::*)(Args...), R, Args...>(name, fn);
+    }
+
+    template <typename R, typename... Args>
+    ApiBinding& method(const char* name, R (Api::*fn)(Args...) const)
+    {
+        return this->add<R (Api::*)(Args...) const, R, Args...>(name, fn);
+    }
+
+    /**
+     * @brief Get the script object having bound methods as its properties.
+     */
+    QScriptValue object() const
+    {
+        return object_;
+    }
+
+private:
+
+    template <typename Fn, typename R, typename... Args>
+    ApiBinding& add(const char* name, Fn fn)
+    {
+        typedef Method<Api, Fn, R, Args...> MethodType;
+        MethodType* m = new MethodType(eng_, api_, fn);
+        methods_.push_back(std::unique_ptr<MethodBase>(m));
+        object_.setProperty(QString::fromLatin1(name),
+                            eng_->newFunction(&MethodType::invoke, m));
+        return *this;
+    }
+
+    QScriptEngine* eng_;
+    Api* api_;
+    QScriptValue object_;
+    std::vector<std::unique_ptr<MethodBase> > methods_;
+};
+
+} // namespace QtScriptBinding
+
+
+/**
+ * @brief Begin description of struct Type. Use in global namespace, followed
+ * by QTSCRIPT_FIELD for each field and QTSCRIPT_END_STRUCT.
+ */
+#define QTSCRIPT_BEGIN_STRUCT(Type) \
+    namespace QtScriptBinding { \
+    template <> \
+    struct StructFields<Type> \
+    { \
+        static const bool described = true; \
+        typedef Type StructType; \
+        template <typename Visitor> \
+        static void describe(Visitor& visit) \
+        {
+
+/**
+ * @brief Describe one field of the struct. Property has the field's name.
+ */
+#define QTSCRIPT_FIELD(field) \
+            visit(#field, &StructType::field);
+
+/**
+ * @brief End struct description.
+ */
+#define QTSCRIPT_END_STRUCT() \
+        } \
+    }; \
+    }
+
+#endif // QTSCRIPTBINDING_HH
@@ -8,12 +8,13 @@
 #include <QScriptEngine>
 #include <QScriptValue>
 #include <QScriptValueList>
+#include <QScriptContext>
 #include "qtscriptapiadapter.hh"
 
 
 QtScriptInterpreter::QtScriptInterpreter() :
     ScriptEmbedderNS::ScriptInterpreter(), api_(), eng_(),
-    adapter_(nullptr), apiObject_()
+    adapter_(nullptr), apiObject_(), contexts_(), global_(), scopeGlobal_()
 {   
 }
 
@@ -28,8 +29,9 @@ void QtScriptInterpreter::SetScriptAPI(std::shared_ptr<ScriptEmbedderNS::ScriptA
     api_ = std::dynamic_pointer_cast<MyScriptAPI>(api);
     Q_ASSERT(api_ != nullptr);
     adapter_ = new QtScriptApiAdapter(api_.get(), &eng_);
-    apiObject_ = eng_.newQObject(adapter_);
-    eng_.globalObject().setProperty("HostAppAPI", apiObject_);
+    apiObject_ = adapter_->object();
+    global_ = eng_.globalObject();
+    global_.setProperty("HostAppAPI", apiObject_);
 }
 
 
@@ -38,13 +40,15 @@ QtScriptInterpreter::runScript(const QString& script, const QStringList& params)
 {
     Q_ASSERT(api_ != nullptr);
 
-    // Set parameters
+    // Set parameters into current scope.
+    QScriptValue scope = eng_.currentContext()->activationObject();
     QScriptValue args = qScriptValueFromSequence(&eng_, params);
-    eng_.globalObject().setProperty("argv", args);
-    eng_.globalObject().setProperty("argc", params.count());
+    scope.setProperty("argv", args);
+    scope.setProperty("argc", params.count());
 
     // Evaluate script.
     ScriptRunResult result;
+    result.result = SUCCESS;
     result.returnValue = eng_.evaluate(script).toInt32();
     if (eng_.hasUncaughtException()){
         result.result = FAILURE;
@@ -55,6 +59,112 @@ QtScriptInterpreter::runScript(const QString& script, const QStringList& params)
 }
 
 
+void QtScriptInterpreter::enterExecutionScope()
+{
+    // Undeclared variables assigned by the script are stored into an empty
+    // global object that inherits the real one, and variables declared by
+    // the script into the activation object of the new context. Both are
+    // discarded when the scope is left, so nothing needs to be restored.
+    scopeGlobal_ = eng_.newObject();
+    scopeGlobal_.setPrototype(global_);
+    eng_.setGlobalObject(scopeGlobal_);
+    eng_.pushContext();
+}
+
+
+void QtScriptInterpreter::leaveExecutionScope()
+{
+    eng_.popContext();
+    eng_.clearExceptions();
+    eng_.setGlobalObject(global_);
+    scopeGlobal_ = QScriptValue();
+}
+
+
+bool QtScriptInterpreter::supportsEntryPoints() const
+{
+    return true;
+}
+
+
+ScriptEmbedderNS::ScriptInterpreter::ScriptRunResult
+QtScriptInterpreter::prepareScript(unsigned handle, const QString& script)
+{
+    Q_ASSERT(api_ != nullptr);
+
+    // Evaluate script in its own context, so that its declarations are
+    // stored into the context's activation object instead of global object.
+    // Undeclared variables assigned by the script must outlive the
+    // execution scope, so they go to the real global object.
+    if (scopeGlobal_.isValid()){
+        eng_.setGlobalObject(global_);
+    }
+    QScriptContext* context = eng_.pushContext();
+    eng_.evaluate(script);
+    QScriptValue scope = context->activationObject();
+    eng_.popContext();
+    if (scopeGlobal_.isValid()){
+        eng_.setGlobalObject(scopeGlobal_);
+    }
+
+    ScriptRunResult result;
+    result.result = SUCCESS;
+    result.returnValue = 0;
+    if (eng_.hasUncaughtException()){
+        result.result = FAILURE;
+        result.errorString = eng_.uncaughtException().toString();
+        eng_.clearExceptions();
+        contexts_.erase(handle);
+        return result;
+    }
+
+    contexts_[handle] = scope;
+    return result;
+}
+
+
+ScriptEmbedderNS::ScriptInterpreter::ScriptRunResult
+QtScriptInterpreter::call(unsigned handle, const QString& function, const QStringList& args)
+{
+    ScriptRunResult result;
+    result.result = FAILURE;
+    result.returnValue = 0;
+
+    auto it = contexts_.find(handle);
+    if (it == contexts_.end()){
+        result.errorString = QString("Script '%1' has not been prepared.").arg(handle);
+        return result;
+    }
+    QScriptValue func = it->second.property(function);
+    if (!func.isFunction()){
+        result.errorString = QString("'%1' is not a function.").arg(function);
+        return result;
+    }
+
+    // Call entry point passing parameters as arguments.
+    QScriptValueList argList;
+    for (const QString& arg : args){
+        argList << QScriptValue(arg);
+    }
+    QScriptValue returnValue = func.call(QScriptValue(), argList);
+    if (eng_.hasUncaughtException()){
+        result.errorString = eng_.uncaughtException().toString();
+        eng_.clearExceptions();
+        return result;
+    }
+
+    result.result = SUCCESS;
+    result.returnValue = returnValue.toInt32();
+    return result;
+}
+
+
+void QtScriptInterpreter::releaseScript(unsigned handle)
+{
+    contexts_.erase(handle);
+}
+
+
 QString QtScriptInterpreter::language() const
 {
     return "QtScript";
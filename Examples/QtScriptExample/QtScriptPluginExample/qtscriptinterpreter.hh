@@ -11,6 +11,7 @@
 #include "myscriptapi.hh"
 #include "qtscriptapiadapter.hh"
 #include <QScriptValue>
+#include <map>
 
 /**
  * @brief Example interpreter for the QtScript language.
@@ -25,6 +26,12 @@ public:
     // ScriptInterpreter interface
     void SetScriptAPI(std::shared_ptr<ScriptEmbedderNS::ScriptAPI> api);
     ScriptRunResult runScript(const QString& script, const QStringList& params);
+    void enterExecutionScope();
+    void leaveExecutionScope();
+    bool supportsEntryPoints() const;
+    ScriptRunResult prepareScript(unsigned handle, const QString& script);
+    ScriptRunResult call(unsigned handle, const QString& function, const QStringList& args);
+    void releaseScript(unsigned handle);
     QString language() const;
 
 private:
@@ -33,6 +40,14 @@ private:
     QScriptEngine eng_;
     QtScriptApiAdapter* adapter_;
     QScriptValue apiObject_;
+
+    // Activation objects of prepared scripts. Handle as key.
+    std::map<unsigned, QScriptValue> contexts_;
+
+    // Engine's own global object, and the global object of the current
+    // execution scope, whose prototype is the engine's global object.
+    QScriptValue global_;
+    QScriptValue scopeGlobal_;
 };
 
 #endif // QTSCRIPTINTERPRETER_HH
@@ -17,12 +17,41 @@ HEADERS += \
     include/interpreterplugin.hh \
     src/serialscriptembedder.hh \
     src/interpreterloader.hh \
+    src/metricsregistry.hh \
+    src/recordingscriptembedder.hh \
+    src/scriptsource.hh \
+    src/sourcecache.hh \
+    src/filestamp.hh \
+    src/sourceloader.hh \
+    src/sourcepool.hh \
+    src/successorpredictor.hh \
     include/scriptinterpreter.hh \
     include/scriptembedderbuilder.hh \
+    include/asynclogger.hh \
+    include/batchlogger.hh \
+    include/executionmetrics.hh \
+    include/executiontracer.hh \
+    include/flightrecorder.hh \
+    include/executiontrace.hh \
+    include/configurationfile.hh \
     doxygeninfo.hh
 
 SOURCES += \
     src/configuration.cc \
     src/serialscriptembedder.cc \
     src/interpreterloader.cc \
-    src/scriptembedderbuilder.cc
+    src/scriptembedderbuilder.cc \
+    src/logger.cc \
+    src/asynclogger.cc \
+    src/metricsregistry.cc \
+    src/executiontracer.cc \
+    src/flightrecorder.cc \
+    src/executiontrace.cc \
+    src/configurationfile.cc \
+    src/recordingscriptembedder.cc \
+    src/scriptsource.cc \
+    src/sourcecache.cc \
+    src/filestamp.cc \
+    src/sourceloader.cc \
+    src/sourcepool.cc \
+    src/successorpredictor.cc
@@ -0,0 +1,129 @@
+/**
+ * @file
+ * @brief Defines the AsyncLogger class, a Logger adapter that delivers
+ * log messages and script results to another Logger in a background thread.
+ * @author Perttu Paarlahti 2016.
+ */
+
+#ifndef ASYNCLOGGER_HH
+#define ASYNCLOGGER_HH
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <QStringList>
+#include "logger.hh"
+
+namespace ScriptEmbedderNS
+{
+
+/**
+ * @brief Logger adapter that decouples logging from script execution.
+ * Each logging thread posts records into its own lock-free ring buffer
+ * of fixed-size entries. A background thread drains the buffers and passes
+ * records to the target Logger. Log messages are formatted only when they
+ * are delivered. Records posted by one thread are delivered in order.
+ * If a ring buffer is full, posting thread waits until there is room.
+ * Ring buffer of a thread is released after the thread has exited and its
+ * records have been delivered.
+ *
+ * Usage: embedder->setLogger(&asyncLogger), where asyncLogger wraps the
+ * actual Logger. Target Logger is called only from the background thread.
+ */
+class AsyncLogger : public Logger
+{
+public:
+
+    /**
+     * @brief Constructor. Starts the background thread.
+     * @param target Logger receiving the records.
+     * @param ringCapacity Capacity of each thread's ring buffer. Rounded up
+     * to next power of two.
+     * @pre target != nullptr, ringCapacity > 0.
+     */
+    AsyncLogger(Logger* target, unsigned ringCapacity = 1024);
+
+    /**
+     * @brief Destructor. Delivers pending records and stops the background thread.
+     * @pre No thread posts records to this logger any more.
+     */
+    virtual ~AsyncLogger();
+
+    /**
+     * @brief Wait until all records posted before this call are delivered.
+     * @pre Not called from the target Logger.
+     * @post Target Logger has received all records posted before the call.
+     */
+    void flush();
+
+    // Logger interface
+    void logMessage(const QString& msg);
+    void logRecord(const LogMessage& msg);
+    void scriptExecuted(const ScriptEntry& script,
+                        const QStringList& params,
+                        int returnValue);
+    void scriptFailed(const ScriptEntry& script,
+                      const QStringList& params,
+                      const QString& errorMsg);
+
+
+private:
+
+    // Fixed-size ring buffer entry. Qt types are implicitly shared, so
+    // copying them into entries does not copy their contents.
+    struct Record
+    {
+        enum Kind {
+            MESSAGE, EXECUTED, FAILED
+        };
+
+        Kind kind;
+        LogMessage message;
+        ScriptEntry script;
+        QStringList params;
+        int returnValue;
+        QString errorMsg;
+    };
+
+    // Single-producer single-consumer ring buffer.
+    struct Ring
+    {
+        std::vector<Record> slots;
+        unsigned mask;
+        std::atomic<unsigned> head; // Next slot written by the producer.
+        std::atomic<unsigned> tail; // Next slot read by the consumer.
+        std::atomic<bool> closed;   // Producer thread has exited.
+
+        explicit Ring(unsigned capacity);
+    };
+
+    Logger* target_;
+    unsigned ringCapacity_;
+    const unsigned long long serial_;
+
+    std::mutex ringsMutex_;
+    std::vector<std::shared_ptr<Ring> > rings_;
+
+    std::atomic<unsigned long long> posted_;
+    std::atomic<unsigned long long> delivered_;
+    std::atomic<bool> stop_;
+    std::atomic<bool> sleeping_; // Background thread may be waiting.
+    std::mutex wakeMutex_;
+    std::condition_variable wakeup_;
+    std::condition_variable drained_;
+    std::thread worker_;
+
+    Ring* threadRing();
+    void post(const Record& record);
+    void wake();
+    void run();
+    bool drain();
+    void deliver(Record& record);
+};
+
+} // namespace ScriptEmbedderNS
+
+#endif // ASYNCLOGGER_HH
@@ -0,0 +1,103 @@
+/**
+ * @file
+ * @brief Defines the BatchLogger interface for receiving script results
+ * in batches, and the compact ScriptResultRecord struct. Component user
+ * provides implementation for this interface.
+ * @author Perttu Paarlahti 2016.
+ */
+
+#ifndef BATCHLOGGER_HH
+#define BATCHLOGGER_HH
+
+#include <QtGlobal>
+#include <cstddef>
+#include "scriptinterpreter.hh"
+#include "executionmetrics.hh"
+
+namespace ScriptEmbedderNS
+{
+
+/**
+ * @brief Compact description of a single script execution.
+ */
+struct ScriptResultRecord
+{
+    /**
+     * @brief Reason for a failed execution.
+     */
+    enum ErrorCode {
+        NONE,                      // Script was executed successfully.
+        NO_SUCH_SCRIPT,            // Script id was not found.
+        SOURCE_NOT_AVAILABLE,      // Source file did not open or was empty.
+        ENTRY_POINTS_NOT_SUPPORTED,// Interpreter does not support entry points.
+        SCRIPT_ERROR               // Interpreter reported failure.
+    };
+
+    /**
+     * @brief Id of the executed script.
+     */
+    unsigned scriptId;
+
+    /**
+     * @brief Execution result (SUCCESS / FAILURE).
+     */
+    ScriptInterpreter::Result status;
+
+    /**
+     * @brief Script's return value. 0 if script failed.
+     */
+    int returnValue;
+
+    /**
+     * @brief Execution duration in nanoseconds.
+     */
+    qint64 duration;
+
+    /**
+     * @brief Reason for failure, or NONE on success.
+     */
+    ErrorCode errorCode;
+
+    /**
+     * @brief Durations of execution phases.
+     */
+    ExecutionTiming timing;
+};
+
+
+/**
+ * @brief Interface for receiving script results in batches.
+ * ScriptEmbedder buffers result records and delivers them once the number
+ * of buffered records or the age of the oldest buffered record reaches
+ * a threshold. This is considerably cheaper than Logger's per-execution
+ * notifications at high execution rates. The user provides implementation
+ * for this interface.
+ */
+class BatchLogger
+{
+public:
+
+    /**
+     * @brief Constructor.
+     */
+    BatchLogger() {}
+
+    /**
+     * @brief Mandatory virtual destructor.
+     */
+    virtual ~BatchLogger() {}
+
+    /**
+     * @brief Method for receiving a batch of script results.
+     * @param records Contiguous array of result records in execution order.
+     * Array is valid only during the call.
+     * @param count Number of records in the array.
+     * @pre count > 0.
+     */
+    virtual void scriptsFinished(const ScriptResultRecord* records,
+                                 std::size_t count) = 0;
+};
+
+} // namespace ScriptEmbedderNS
+
+#endif // BATCHLOGGER_HH
@@ -9,8 +9,10 @@
 #define CONFIGURATION_HH
 
 #include <QString>
+#include <QSharedDataPointer>
 #include <map>
 #include <memory>
+#include <vector>
 #include "scriptapi.hh"
 
 namespace ScriptEmbedderNS
@@ -19,19 +21,39 @@ namespace ScriptEmbedderNS
 // Forward declaration for user-defined scipt API.
 class ScriptAPI;
 
+// Forward declaration for Configuration's shared data.
+class ConfigurationData;
+
 
 /**
  * @brief Represents configuration for single script entity.
  */
 struct ScriptEntry
 {
+    /**
+     * @brief How the source of a script read to RAM is stored.
+     * COPY: file is read and decoded into a string at configuration.
+     * MAPPED: file is memory-mapped read-only. Source is used in place and
+     * decoded only once when first needed as a string. The file must not be
+     * truncated while the script is configured, and on some platforms it
+     * cannot be modified or removed while mapped. Qt resources are copied.
+     * COMPRESSED: file is read and kept compressed in RAM. Source is
+     * decompressed on execution, and a small number of recently executed
+     * scripts are kept decompressed. Suits large catalogs of rarely
+     * executed scripts.
+     */
+    enum Storage {
+        COPY, MAPPED, COMPRESSED
+    };
+
     /**
      * @brief Unique id for script entity.
      */
     unsigned id;
 
     /**
-     * @brief Path to script source file.
+     * @brief Path to script source file. Qt resource paths (":/...") are
+     * supported. Not used if source is set.
      */
     QString scriptPath;
 
@@ -53,9 +75,47 @@ struct ScriptEntry
      */
     unsigned priority;
 
+    /**
+     * @brief Name of the script's entry-point function. If empty, the whole
+     * script is evaluated on each execution. Else the script is evaluated
+     * only once, and each execution calls this function passing execution
+     * parameters as its arguments. Requires an interpreter that supports
+     * entry points (see ScriptInterpreter::supportsEntryPoints()).
+     * Scripts of the same language having identical sources share one
+     * evaluated program: variables defined at the top level of the script
+     * are shared by them, and changes made to them by one call are visible
+     * to later calls of any of these scripts.
+     */
+    QString entryPoint;
+
+    /**
+     * @brief Storage of the source, if readToRAM is true.
+     */
+    Storage storage;
+
+    /**
+     * @brief Inline source code. If not empty, script does not have a source
+     * file, and it is always kept in RAM as if readToRAM was true. Storage
+     * MAPPED is handled as COPY for inline scripts.
+     */
+    QString source;
+
+    /**
+     * @brief Source caching of scripts read on demand. If negative, source
+     * file is read on each execution. Else source is kept in RAM after the first
+     * execution, and file's modification time, size and inode are checked
+     * at most once per checkInterval milliseconds (0: before each execution).
+     * File is read again only when it has changed, so scripts remain
+     * editable without the cost of reading them on each execution. Storage
+     * MAPPED is handled as COPY for cached scripts. Not used if readToRAM is
+     * true or script is inline.
+     */
+    int checkInterval;
+
     /**
      * @brief Constructor. Sets default values for fields:
-     * id = 0, scriptPath = "", scriptLanguage = "", readToRAM = false, priority = 0.
+     * id = 0, scriptPath = "", scriptLanguage = "", readToRAM = false, priority = 0,
+     * entryPoint = "", storage = COPY, source = "", checkInterval = -1.
      */
     ScriptEntry();
 
@@ -66,6 +126,9 @@ struct ScriptEntry
      * @param language Script's language.
      * @param toRAM Is script read to RAM at configuration.
      * @param priority Script' priority (has effect only in asynchronous mode).
+     * @param entryPoint Name of the entry-point function, or empty string
+     * if the whole script is evaluated on each execution.
+     * @param storage Storage of the source if it is read to RAM.
      * @pre Path and language are not empty strings.
      * @post New entry has given values as its attributes.
      */
@@ -73,7 +136,42 @@ struct ScriptEntry
                 const QString& path,
                 const QString& language,
                 bool toRAM = false,
-                unsigned priority = 0);
+                unsigned priority = 0,
+                const QString& entryPoint = QString(),
+                Storage storage = COPY);
+
+    /**
+     * @brief Create script having inline source code instead of a file.
+     * @param scriptId Script's unique id number.
+     * @param source Script's source code.
+     * @param language Script's language.
+     * @param priority Script' priority (has effect only in asynchronous mode).
+     * @param entryPoint Name of the entry-point function, or empty string
+     * if the whole script is evaluated on each execution.
+     * @param storage Storage of the source.
+     * @return New entry with readToRAM set and empty scriptPath.
+     * @pre Source and language are not empty strings.
+     */
+    static ScriptEntry fromSource(unsigned scriptId,
+                                  const QString& source,
+                                  const QString& language,
+                                  unsigned priority = 0,
+                                  const QString& entryPoint = QString(),
+                                  Storage storage = COPY);
+
+    /**
+     * @brief Check if script has inline source code.
+     * @return True, if source is not empty.
+     */
+    bool isInline() const;
+
+    /**
+     * @brief Check if source of an on-demand script is cached between
+     * executions (see checkInterval).
+     * @return True, if script is not inline or read to RAM, and
+     * checkInterval is not negative.
+     */
+    bool isCached() const;
 
     /**
      * @brief Comparison for equality is impemented for convenience.
@@ -123,10 +221,73 @@ struct InterpreterEntry
 };
 
 
+/**
+ * @brief Result of validating a Configuration. Lists all errors found.
+ */
+struct ValidationReport
+{
+    /**
+     * @brief One validation error.
+     */
+    struct Error
+    {
+        /**
+         * @brief Kind of the error.
+         */
+        enum Kind {
+            NO_SCRIPT_API,             // ScriptAPI has not been set.
+            NO_INTERPRETERS,           // No interpreters have been set.
+            INVALID_SCRIPT_PATH,       // Script file does not exist.
+            NO_SUITABLE_INTERPRETER,   // No interpreter for script's language.
+            INVALID_PLUGIN_PATH        // Plugin path is not a library path.
+        };
+
+        /**
+         * @brief Kind of the error.
+         */
+        Kind kind;
+
+        /**
+         * @brief Id of the script having the error. 0 for other errors.
+         */
+        unsigned scriptId;
+
+        /**
+         * @brief Human readable description of the error.
+         */
+        QString message;
+    };
+
+    /**
+     * @brief Errors in the order: ScriptAPI, interpreters, scripts (in id
+     * order), plugin paths.
+     */
+    std::vector<Error> errors;
+
+    /**
+     * @brief Check if the configuration was valid.
+     * @return True, if there are no errors.
+     */
+    bool isValid() const
+    {
+        return errors.empty();
+    }
+
+    /**
+     * @brief Get description of all errors.
+     * @return Error messages separated by newlines, or empty string if
+     * configuration was valid.
+     */
+    QString errorString() const;
+};
+
+
 /**
  * @brief Represents the ScriptEmbedder configutation.
  * Contains neccessary information about interpreters, predefined scripts
- * and the ScriptAPI object.
+ * and the ScriptAPI object. Configuration is implicitly shared like Qt
+ * containers: copies share the same data until one of them is modified,
+ * so copying is cheap regardless of the number of scripts.
  */
 class Configuration
 {
@@ -154,6 +315,24 @@ public:
                   std::map<QString, InterpreterEntry> interpreters,
                   std::map<unsigned, ScriptEntry> scripts);
 
+    /**
+     * @brief Copy constructor. Shares data with other.
+     * @param other Copied configuration.
+     */
+    Configuration(const Configuration& other);
+
+    /**
+     * @brief Assignment operator. Shares data with other.
+     * @param other Assigned configuration.
+     * @return This configuration.
+     */
+    Configuration& operator=(const Configuration& other);
+
+    /**
+     * @brief Destructor.
+     */
+    ~Configuration();
+
     /**
      * @brief Assign script api.
      * @param api Used script api object.
@@ -208,9 +387,10 @@ public:
     /**
      * @brief Get currently assigned interpreters.
      * @return Current interpreters in map. Script language is the key.
+     * Reference is valid until this configuration is modified or destroyed.
      * @pre -
      */
-    std::map<QString, InterpreterEntry> interpreters() const;
+    const std::map<QString, InterpreterEntry>& interpreters() const;
 
     /**
      * @brief Add new script entry in configuration.
@@ -240,7 +420,8 @@ public:
      * @brief Get script entry wit given id.
      * @param id Id number of the script.
      * @return Script matching the id. If no such id exists, returns default
-     * ScriptEntry (id=0, path="", language="", readToRam=false, priority=0).
+     * ScriptEntry (id=0, path="", language="", readToRam=false, priority=0,
+     * entryPoint="").
      * @pre -
      */
     ScriptEntry getScript(unsigned id) const;
@@ -248,9 +429,10 @@ public:
     /**
      * @brief Get assigned scripts.
      * @return Currently set scripts in map. Script id is the key.
+     * Reference is valid until this configuration is modified or destroyed.
      * @pre -
      */
-    std::map<unsigned, ScriptEntry> scripts() const;
+    const std::map<unsigned, ScriptEntry>& scripts() const;
 
     /**
      * @brief Check if current configuration is valid.
@@ -268,17 +450,25 @@ public:
 
     /**
      * @brief Get more information on why configuration is invalid.
-     * @return If configuration is invalid, this returns more detailed
-     * description. Else returns empty string.
+     * @return If configuration is invalid, this returns description of
+     * the first error found by validate(). Else returns empty string.
      */
     QString errorString() const;
 
+    /**
+     * @brief Validate configuration in a single pass using the rules listed
+     * in isValid(). Each distinct script path is checked only once, and large
+     * number of paths are checked in parallel. Prefer this over calling
+     * isValid() and errorString() when both are needed.
+     * @return Report listing all errors.
+     * @pre -
+     */
+    ValidationReport validate() const;
+
 
 private:
 
-    std::shared_ptr<ScriptAPI> api_;
-    std::map<QString, InterpreterEntry> interpreters_;
-    std::map<unsigned, ScriptEntry> scripts_;
+    QSharedDataPointer<ConfigurationData> d_;
 };
 
 } // namespace ScriptEmbedderNS
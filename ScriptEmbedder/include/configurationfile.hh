@@ -0,0 +1,198 @@
+/**
+ * @file
+ * @brief Defines the ConfigurationFile class for saving and loading
+ * Configurations in a compact binary format, and importing and exporting
+ * them as JSON.
+ * @author Perttu Paarlahti 2016.
+ */
+
+#ifndef CONFIGURATIONFILE_HH
+#define CONFIGURATIONFILE_HH
+
+#include <QByteArray>
+#include <QFile>
+#include <QString>
+#include <vector>
+#include "configuration.hh"
+
+namespace ScriptEmbedderNS
+{
+
+/**
+ * @brief Reads and writes configuration files.
+ *
+ * Binary files are memory-mapped when opened and used in place: entries
+ * are decoded only when they are accessed. A binary file consists of
+ * (all integers are little-endian quint32):
+ *  - header: magic "SECF", version, interpreter count, script count,
+ *    string count, offset of string data;
+ *  - interpreter entries: language and plugin path string indices;
+ *  - script entries sorted by id: id, path, language and entry point
+ *    string indices, priority, flags (bit 0: readToRAM, bits 1-2:
+ *    storage), inline source string index and check interval (int);
+ *  - string table: offset and length of each string within string data;
+ *  - string data: UTF-8 encoded strings, each distinct string only once.
+ * Entry point or source index NO_STRING means that script has no entry
+ * point or inline source.
+ *
+ * ScriptAPI is not stored, as it is an object created by the application.
+ *
+ * JSON files are meant for humans:
+ * {"interpreters": [{"language": "...", "plugin": "..."}, ...],
+ *  "scripts": [{"id": 0, "path": "...", "language": "...", "readToRAM": false,
+ *               "priority": 0, "entryPoint": "...", "storage": "copy",
+ *               "checkInterval": -1}, ...]}
+ * Fields readToRAM, priority, entryPoint, storage and checkInterval are
+ * optional. Storage is
+ * "copy", "mapped" or "compressed". Instead of "path", a script may have its
+ * source code inline in "source".
+ */
+class ConfigurationFile
+{
+public:
+
+    /**
+     * @brief Index value meaning no string.
+     */
+    static const quint32 NO_STRING = 0xffffffff;
+
+    /**
+     * @brief Constructor. Creates object without open file.
+     */
+    ConfigurationFile();
+
+    /**
+     * @brief Destructor. Unmaps the file.
+     */
+    ~ConfigurationFile();
+
+    /**
+     * @brief Map binary configuration file into memory. Header and string
+     * indices are checked, but entries are not decoded.
+     * @param path Path of the binary file.
+     * @return True, if file was mapped and is valid. Otherwise error message
+     * is available in errorString().
+     * @post Previously opened file is closed.
+     */
+    bool open(const QString& path);
+
+    /**
+     * @brief Unmap the file.
+     * @post isOpen() returns false.
+     */
+    void close();
+
+    /**
+     * @brief Check if a binary file is open.
+     * @return True, if file is open.
+     */
+    bool isOpen() const;
+
+    /**
+     * @brief Get number of interpreters in the open file.
+     * @return Number of interpreters.
+     * @pre isOpen().
+     */
+    unsigned interpreterCount() const;
+
+    /**
+     * @brief Decode interpreter entry.
+     * @param index Index of the entry.
+     * @return Interpreter entry.
+     * @pre isOpen(), index < interpreterCount().
+     */
+    InterpreterEntry interpreter(unsigned index) const;
+
+    /**
+     * @brief Get number of scripts in the open file.
+     * @return Number of scripts.
+     * @pre isOpen().
+     */
+    unsigned scriptCount() const;
+
+    /**
+     * @brief Decode script entry.
+     * @param index Index of the entry. Entries are in id order.
+     * @return Script entry.
+     * @pre isOpen(), index < scriptCount().
+     */
+    ScriptEntry script(unsigned index) const;
+
+    /**
+     * @brief Find script by id using binary search over the mapped entries.
+     * @param id Script id.
+     * @param script Receives the script, if found.
+     * @return True, if script was found.
+     * @pre isOpen().
+     */
+    bool findScript(unsigned id, ScriptEntry& script) const;
+
+    /**
+     * @brief Decode all entries into a Configuration. Strings used by several
+     * entries are decoded once and shared.
+     * @param api ScriptAPI for the configuration.
+     * @return New configuration.
+     * @pre isOpen().
+     */
+    Configuration toConfiguration(std::shared_ptr<ScriptAPI> api) const;
+
+    /**
+     * @brief Save configuration into a binary file.
+     * @param conf Saved configuration. ScriptAPI is not saved.
+     * @param path Path of the binary file. Existing file is overwritten.
+     * @return True, if file was written. Otherwise error message is
+     * available in errorString().
+     * @pre path is not the path of the currently open file.
+     */
+    bool save(const Configuration& conf, const QString& path);
+
+    /**
+     * @brief Import interpreters and scripts from JSON.
+     * @param json JSON document.
+     * @param conf Configuration receiving the entries. Entries with existing
+     * language or id replace the existing ones.
+     * @return True, if document was valid. Otherwise error message is
+     * available in errorString() and conf is not modified.
+     */
+    bool fromJson(const QByteArray& json, Configuration& conf);
+
+    /**
+     * @brief Export interpreters and scripts as JSON.
+     * @param conf Exported configuration. ScriptAPI is not exported.
+     * @return JSON document.
+     */
+    static QByteArray toJson(const Configuration& conf);
+
+    /**
+     * @brief Get latest error message.
+     * @return Error message, or empty string if no errors have occured.
+     */
+    QString errorString() const;
+
+
+private:
+
+    ConfigurationFile(const ConfigurationFile&) = delete;
+    ConfigurationFile& operator=(const ConfigurationFile&) = delete;
+
+    QFile file_;
+    const uchar* data_;
+    qint64 size_;
+    quint32 interpreterCount_;
+    quint32 scriptCount_;
+    quint32 stringCount_;
+    const uchar* interpreters_;
+    const uchar* scripts_;
+    const uchar* strings_;
+    const uchar* stringData_;
+    QString errorStr_;
+
+    bool mapFile(const QString& path);
+    QString string(quint32 index, std::vector<QString>* cache) const;
+    ScriptEntry decodeScript(const uchar* entry, std::vector<QString>* cache) const;
+    bool fail(const QString& msg);
+};
+
+} // namespace ScriptEmbedderNS
+
+#endif // CONFIGURATIONFILE_HH
@@ -0,0 +1,163 @@
+/**
+ * @file
+ * @brief Defines structs describing script execution metrics collected by
+ * the ScriptEmbedder component. See ScriptEmbedder::metrics().
+ * @author Perttu Paarlahti 2016.
+ */
+
+#ifndef EXECUTIONMETRICS_HH
+#define EXECUTIONMETRICS_HH
+
+#include <QString>
+#include <QtGlobal>
+#include <map>
+
+namespace ScriptEmbedderNS
+{
+
+/**
+ * @brief Statistics of measured durations. All times are in nanoseconds.
+ * Percentiles are estimated from a logarithmic histogram, and have relative
+ * error of at most 12.5%.
+ */
+struct TimeStatistics
+{
+    /**
+     * @brief Number of measurements.
+     */
+    quint64 count;
+
+    /**
+     * @brief Sum of measured durations.
+     */
+    qint64 total;
+
+    /**
+     * @brief Longest measured duration.
+     */
+    qint64 max;
+
+    /**
+     * @brief Median.
+     */
+    qint64 p50;
+
+    /**
+     * @brief 99th percentile.
+     */
+    qint64 p99;
+
+    /**
+     * @brief 99.9th percentile.
+     */
+    qint64 p999;
+
+    /**
+     * @brief Constructor. Sets all fields to 0.
+     */
+    TimeStatistics() :
+        count(0), total(0), max(0), p50(0), p99(0), p999(0) {}
+};
+
+
+/**
+ * @brief Execution metrics of one script or one language.
+ */
+struct ExecutionMetrics
+{
+    /**
+     * @brief Number of executions.
+     */
+    quint64 runs;
+
+    /**
+     * @brief Number of failed executions.
+     */
+    quint64 failures;
+
+    /**
+     * @brief Durations of whole executions.
+     */
+    TimeStatistics latency;
+
+    /**
+     * @brief Time executions waited in a queue before they were started.
+     * Not measured by embedders that execute scripts immediately.
+     */
+    TimeStatistics queueWait;
+
+    /**
+     * @brief Time spent loading script sources from disk. Measured only
+     * for executions that loaded the source.
+     */
+    TimeStatistics sourceLoad;
+
+    /**
+     * @brief Constructor. Sets all counters to 0.
+     */
+    ExecutionMetrics() :
+        runs(0), failures(0), latency(), queueWait(), sourceLoad() {}
+};
+
+
+/**
+ * @brief Durations of the phases of a single execution in nanoseconds,
+ * measured with a monotonic clock. Phases that were not performed during
+ * the execution have value -1.
+ */
+struct ExecutionTiming
+{
+    /**
+     * @brief Finding the script entry.
+     */
+    qint64 lookup;
+
+    /**
+     * @brief Reading the source file from disk.
+     */
+    qint64 load;
+
+    /**
+     * @brief Decoding the source file into a string.
+     */
+    qint64 decode;
+
+    /**
+     * @brief Running the script in the interpreter, including preparation
+     * of entry-point scripts.
+     */
+    qint64 run;
+
+    /**
+     * @brief Notifying the Logger about the result.
+     */
+    qint64 log;
+
+    /**
+     * @brief Constructor. Sets all phases as not performed (-1).
+     */
+    ExecutionTiming() :
+        lookup(-1), load(-1), decode(-1), run(-1), log(-1) {}
+};
+
+
+/**
+ * @brief Snapshot of execution metrics.
+ */
+struct MetricsSnapshot
+{
+    /**
+     * @brief Metrics per script. Script id as key. Contains only scripts
+     * that have been executed.
+     */
+    std::map<unsigned, ExecutionMetrics> scripts;
+
+    /**
+     * @brief Metrics per script language. Language as key.
+     */
+    std::map<QString, ExecutionMetrics> languages;
+};
+
+} // namespace ScriptEmbedderNS
+
+#endif // EXECUTIONMETRICS_HH
@@ -0,0 +1,175 @@
+/**
+ * @file
+ * @brief Defines classes for writing and reading execution traces: compact
+ * binary files recording ScriptEmbedder::execute() calls for replaying them
+ * later, e.g. with the LoadGenerator tool.
+ * @author Perttu Paarlahti 2016.
+ */
+
+#ifndef EXECUTIONTRACE_HH
+#define EXECUTIONTRACE_HH
+
+#include <QByteArray>
+#include <QFile>
+#include <QString>
+#include <QStringList>
+
+namespace ScriptEmbedderNS
+{
+
+/**
+ * @brief One recorded execute() call.
+ */
+struct TraceEvent
+{
+    /**
+     * @brief Time of the call in nanoseconds since recording started.
+     */
+    qint64 timestamp;
+
+    /**
+     * @brief Id of the executed script.
+     */
+    unsigned scriptId;
+
+    /**
+     * @brief Parameters passed to the script.
+     */
+    QStringList params;
+
+    /**
+     * @brief Constructor.
+     */
+    TraceEvent() : timestamp(0), scriptId(0), params() {}
+};
+
+
+/**
+ * @brief Writes execution traces. A trace file begins with the magic bytes
+ * "SETR" and a format version byte. Each event is stored as unsigned
+ * LEB128 varints: time since previous event, script id and parameter
+ * count, followed by each parameter as byte length and UTF-8 bytes.
+ * Events are buffered and written to the file in large blocks.
+ */
+class ExecutionTraceWriter
+{
+public:
+
+    /**
+     * @brief Constructor. Creates writer without output file.
+     */
+    ExecutionTraceWriter();
+
+    /**
+     * @brief Destructor. Closes the output file.
+     */
+    ~ExecutionTraceWriter();
+
+    /**
+     * @brief Create a new trace file. Existing file is overwritten.
+     * @param path Path of the trace file.
+     * @return True, if file was created. Otherwise error message is
+     * available in errorString().
+     * @pre No trace file is open.
+     */
+    bool open(const QString& path);
+
+    /**
+     * @brief Check if a trace file is open.
+     * @return True, if events can be written.
+     */
+    bool isOpen() const;
+
+    /**
+     * @brief Add event into the trace.
+     * @param event Event to be written. Timestamps of consecutive events
+     * must not decrease; a decreasing timestamp is recorded as equal to the
+     * previous one.
+     * @return True, if event was written successfully.
+     * @pre isOpen().
+     */
+    bool write(const TraceEvent& event);
+
+    /**
+     * @brief Write buffered events and close the file.
+     * @return True, if all events were written successfully.
+     */
+    bool close();
+
+    /**
+     * @brief Get latest error message.
+     * @return Error message, or empty string if no errors have occured.
+     */
+    QString errorString() const;
+
+
+private:
+
+    ExecutionTraceWriter(const ExecutionTraceWriter&) = delete;
+    ExecutionTraceWriter& operator=(const ExecutionTraceWriter&) = delete;
+
+    QFile file_;
+    QByteArray buffer_;
+    qint64 previous_;
+    QString errorStr_;
+
+    bool flush();
+};
+
+
+/**
+ * @brief Reads execution traces written by ExecutionTraceWriter. Trace is
+ * read from the file in large blocks as events are read, so traces of any
+ * size can be read with little memory.
+ */
+class ExecutionTraceReader
+{
+public:
+
+    /**
+     * @brief Constructor. Creates reader without trace.
+     */
+    ExecutionTraceReader();
+
+    /**
+     * @brief Open trace file. Previously opened file is closed.
+     * @param path Path of the trace file.
+     * @return True, if file was read and has a valid header. Otherwise error
+     * message is available in errorString().
+     */
+    bool open(const QString& path);
+
+    /**
+     * @brief Read next event.
+     * @param event Receives the event.
+     * @return True, if event was read. False at the end of the trace or if
+     * trace is corrupted; in the latter case errorString() is not empty.
+     */
+    bool next(TraceEvent& event);
+
+    /**
+     * @brief Get latest error message.
+     * @return Error message, or empty string if no errors have occured.
+     */
+    QString errorString() const;
+
+
+private:
+
+    ExecutionTraceReader(const ExecutionTraceReader&) = delete;
+    ExecutionTraceReader& operator=(const ExecutionTraceReader&) = delete;
+
+    QFile file_;
+    QByteArray data_; // Unread part of the file starts at position_.
+    int position_;
+    qint64 offset_;   // File offset of data_.
+    qint64 previous_;
+    QString errorStr_;
+
+    bool fill(int size);
+    bool readVarint(quint64& value);
+};
+
+} // namespace ScriptEmbedderNS
+
+#endif // EXECUTIONTRACE_HH
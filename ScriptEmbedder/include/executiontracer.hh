@@ -0,0 +1,155 @@
+/**
+ * @file
+ * @brief Defines the ExecutionTracer class that records timeline of script
+ * executions and exports it in Chrome's trace-event format.
+ * @author Perttu Paarlahti 2016.
+ */
+
+#ifndef EXECUTIONTRACER_HH
+#define EXECUTIONTRACER_HH
+
+#include <mutex>
+#include <vector>
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QString>
+#include "scriptinterpreter.hh"
+
+namespace ScriptEmbedderNS
+{
+
+/**
+ * @brief Records begin/end spans of execution phases into a bounded
+ * in-memory buffer. When the buffer is full, the oldest spans are
+ * overwritten. Recorded spans can be exported as trace-event JSON, which
+ * can be opened in chrome://tracing or Perfetto. Spans are grouped by the
+ * recording thread, and carry the script id and the interpreter instance
+ * as arguments.
+ *
+ * Usage: embedder->setTracer(&tracer). Recording is thread safe.
+ */
+class ExecutionTracer
+{
+public:
+
+    /**
+     * @brief Traced phases of an execution.
+     */
+    enum Phase {
+        ENQUEUE,  // Dispatching execution request until execution begins.
+        LOAD,     // Reading and decoding script source.
+        COMPILE,  // Evaluating entry-point script before its first call.
+        RUN,      // Running script in the interpreter.
+        LOG       // Notifying Logger about the result.
+    };
+
+    /**
+     * @brief One recorded span. Times are nanoseconds since the tracer
+     * was created.
+     */
+    struct Span
+    {
+        Phase phase;
+        unsigned scriptId;
+        const ScriptInterpreter* interpreter; // nullptr if not known.
+        QString language;
+        unsigned thread;                      // Small per-thread number.
+        qint64 begin;
+        qint64 end;
+    };
+
+    /**
+     * @brief Constructor.
+     * @param capacity Maximum number of buffered spans.
+     * @param outputPath If not empty, spans are written to this file
+     * when tracer is destroyed.
+     * @pre capacity > 0.
+     */
+    ExecutionTracer(unsigned capacity = 65536,
+                    const QString& outputPath = QString());
+
+    /**
+     * @brief Destructor. Writes buffered spans into output path, if set.
+     * @pre Tracer is not used by any embedder.
+     */
+    ~ExecutionTracer();
+
+    /**
+     * @brief Current time of the tracer's monotonic clock.
+     * @return Nanoseconds since tracer was created.
+     */
+    qint64 now() const;
+
+    /**
+     * @brief Record one span. Overwrites the oldest span, if buffer is full.
+     * @param phase Traced phase.
+     * @param scriptId Id of the executed script.
+     * @param interpreter Interpreter instance executing the script, or nullptr.
+     * @param language Script's language.
+     * @param begin Begin time, see now().
+     * @param end End time, see now().
+     * @pre begin <= end.
+     */
+    void record(Phase phase,
+                unsigned scriptId,
+                const ScriptInterpreter* interpreter,
+                const QString& language,
+                qint64 begin,
+                qint64 end);
+
+    /**
+     * @brief Get buffered spans.
+     * @return Spans from oldest to newest.
+     */
+    std::vector<Span> spans() const;
+
+    /**
+     * @brief Get number of spans overwritten since last clear().
+     * @return Number of dropped spans.
+     */
+    unsigned long long dropped() const;
+
+    /**
+     * @brief Remove all buffered spans.
+     * @post Buffer is empty and dropped() returns 0.
+     */
+    void clear();
+
+    /**
+     * @brief Export buffered spans.
+     * @return Trace-event JSON document.
+     */
+    QByteArray toJson() const;
+
+    /**
+     * @brief Write buffered spans into a file as trace-event JSON.
+     * @param path Output file.
+     * @return True, if file was written successfully.
+     */
+    bool dump(const QString& path) const;
+
+    /**
+     * @brief Get name of a phase as shown in the trace.
+     * @param phase Phase.
+     * @return Phase name.
+     */
+    static const char* phaseName(Phase phase);
+
+
+private:
+
+    ExecutionTracer(const ExecutionTracer&) = delete;
+    ExecutionTracer& operator=(const ExecutionTracer&) = delete;
+
+    QElapsedTimer clock_;
+    QString outputPath_;
+    mutable std::mutex mutex_;
+    std::vector<Span> spans_;
+    std::size_t capacity_;
+    std::size_t next_;
+    unsigned long long dropped_;
+};
+
+} // namespace ScriptEmbedderNS
+
+#endif // EXECUTIONTRACER_HH
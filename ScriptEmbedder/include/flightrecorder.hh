@@ -0,0 +1,159 @@
+/**
+ * @file
+ * @brief Defines the FlightRecorder class that keeps compact records of
+ * the latest script executions for post-mortem analysis.
+ * @author Perttu Paarlahti 2016.
+ */
+
+#ifndef FLIGHTRECORDER_HH
+#define FLIGHTRECORDER_HH
+
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <QElapsedTimer>
+#include <QString>
+#include "batchlogger.hh"
+
+namespace ScriptEmbedderNS
+{
+
+/**
+ * @brief Fixed-size ring of the latest executions. When the ring is full,
+ * the oldest record is overwritten. Recording does not allocate or lock:
+ * it stores a few integers into the next slot. Each slot is guarded by
+ * a sequence number, so that readers skip slots being written.
+ *
+ * Only one thread may record. Records may be read from any thread, and
+ * dump(int) may be called from a signal handler.
+ */
+class FlightRecorder
+{
+public:
+
+    /**
+     * @brief Compact record of one execution.
+     */
+    struct Entry
+    {
+        /**
+         * @brief Running number of the execution, starting from 1.
+         */
+        quint64 sequence;
+
+        /**
+         * @brief Id of the executed script.
+         */
+        unsigned scriptId;
+
+        /**
+         * @brief Hash of the script parameters.
+         */
+        uint paramsHash;
+
+        /**
+         * @brief Start time in nanoseconds since the recorder was created.
+         */
+        qint64 start;
+
+        /**
+         * @brief Execution duration in nanoseconds.
+         */
+        qint64 duration;
+
+        /**
+         * @brief Execution result.
+         */
+        ScriptInterpreter::Result status;
+
+        /**
+         * @brief Reason for failure, or NONE on success.
+         */
+        ScriptResultRecord::ErrorCode errorCode;
+
+        /**
+         * @brief Address of the executing interpreter instance, or 0.
+         */
+        quintptr interpreter;
+    };
+
+    /**
+     * @brief Constructor. Allocates the ring.
+     * @param capacity Number of records kept.
+     * @pre capacity > 0.
+     */
+    explicit FlightRecorder(unsigned capacity = 256);
+
+    /**
+     * @brief Destructor.
+     */
+    ~FlightRecorder();
+
+    /**
+     * @brief Record finished execution. Start time is derived from the
+     * current time and the duration.
+     * @param scriptId Id of the executed script.
+     * @param paramsHash Hash of the script parameters.
+     * @param duration Execution duration in nanoseconds.
+     * @param status Execution result.
+     * @param errorCode Reason for failure.
+     * @param interpreter Executing interpreter instance, or nullptr.
+     * @pre Not called concurrently from several threads.
+     */
+    void record(unsigned scriptId,
+                uint paramsHash,
+                qint64 duration,
+                ScriptInterpreter::Result status,
+                ScriptResultRecord::ErrorCode errorCode,
+                const ScriptInterpreter* interpreter);
+
+    /**
+     * @brief Get number of records kept.
+     * @return Capacity given to the constructor.
+     */
+    unsigned capacity() const;
+
+    /**
+     * @brief Get current records.
+     * @return Records from oldest to newest.
+     */
+    std::vector<Entry> entries() const;
+
+    /**
+     * @brief Format current records as text, one record per line.
+     * @return Records from oldest to newest.
+     */
+    QString dump() const;
+
+    /**
+     * @brief Write current records as text into a file descriptor. This
+     * method is async-signal-safe: it does not allocate memory or take locks.
+     * @param fd File descriptor, e.g. 2 for standard error.
+     * @return True, if all records were written.
+     */
+    bool dump(int fd) const;
+
+
+private:
+
+    struct Slot
+    {
+        std::atomic<quint64> sequence; // 0 while slot is being written.
+        Entry entry;
+    };
+
+    FlightRecorder(const FlightRecorder&) = delete;
+    FlightRecorder& operator=(const FlightRecorder&) = delete;
+
+    QElapsedTimer clock_;
+    const unsigned capacity_;
+    std::unique_ptr<Slot[]> slots_;
+    std::atomic<quint64> written_;
+
+    bool read(quint64 sequence, Entry& entry) const;
+    static std::size_t format(const Entry& entry, char* buffer, std::size_t size);
+};
+
+} // namespace ScriptEmbedderNS
+
+#endif // FLIGHTRECORDER_HH
@@ -10,10 +10,75 @@
 
 #include <QString>
 #include "configuration.hh"
+#include "executionmetrics.hh"
 
 namespace ScriptEmbedderNS
 {
 
+/**
+ * @brief Log message whose formatting is deferred until the message text
+ * is actually needed. Message consists of a format string having
+ * placeholders %1, %2 and %3, and up to three arguments. Arguments are
+ * substituted the same way as by chained QString::arg calls.
+ */
+class LogMessage
+{
+public:
+
+    /**
+     * @brief Constructor. Creates empty message.
+     */
+    LogMessage();
+
+    /**
+     * @brief Constructor.
+     * @param format Format string. String is not copied.
+     * @pre format is a string literal or otherwise outlives this object.
+     */
+    LogMessage(const char* format);
+
+    /**
+     * @brief Constructor for already formatted messages.
+     * @param message Message text.
+     */
+    LogMessage(const QString& message);
+
+    /**
+     * @brief Add string argument.
+     * @param a Argument replacing the next placeholder.
+     * @return This message.
+     * @pre Message has less than three arguments.
+     */
+    LogMessage& arg(const QString& a);
+
+    /**
+     * @brief Add numeric argument.
+     * @param a Argument replacing the next placeholder.
+     * @return This message.
+     * @pre Message has less than three arguments.
+     */
+    LogMessage& arg(unsigned a);
+
+    /**
+     * @brief Format message.
+     * @return Message text with arguments substituted.
+     */
+    QString toString() const;
+
+
+private:
+
+    static const int MAX_ARGS = 3;
+
+    const char* format_;
+    QString text_;
+    QString strArgs_[MAX_ARGS];
+    unsigned numArgs_[MAX_ARGS];
+    bool isNumber_[MAX_ARGS];
+    int argCount_;
+};
+
+
 /**
  * @brief This is the interface for reporting ScriptEmbedder events to user.
  * The user provides implementation for this interface.
@@ -40,6 +105,18 @@ public:
      */
     virtual void logMessage(const QString& msg) = 0;
 
+    /**
+     * @brief Method for receiving general log messages whose formatting is
+     * deferred. ScriptEmbedder sends its log messages through this method.
+     * Default implementation formats the message and passes it to logMessage().
+     * Override this to postpone or skip formatting.
+     * @param msg Log message.
+     */
+    virtual void logRecord(const LogMessage& msg)
+    {
+        this->logMessage(msg.toString());
+    }
+
     /**
      * @brief Method for receiving notifications on successfully run scripts.
      * @param script Script that has been executed.
@@ -61,6 +138,21 @@ public:
     virtual void scriptFailed(const ScriptEntry& script,
                               const QStringList& params,
                               const QString& errorMsg) = 0;
+
+    /**
+     * @brief Method for receiving phase timings of executions. Called after
+     * scriptExecuted() or scriptFailed() for executions of existing scripts.
+     * Default implementation does nothing.
+     * @param script Script that was executed.
+     * @param timing Durations of execution phases, including the preceding
+     * scriptExecuted() or scriptFailed() call.
+     */
+    virtual void scriptTimed(const ScriptEntry& script,
+                             const ExecutionTiming& timing)
+    {
+        Q_UNUSED(script);
+        Q_UNUSED(timing);
+    }
 };
 
 } // namespace ScriptEmbedderNS
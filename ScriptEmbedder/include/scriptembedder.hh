@@ -10,7 +10,12 @@
 
 #include "configuration.hh"
 #include "logger.hh"
+#include "batchlogger.hh"
+#include "executionmetrics.hh"
+#include "executiontracer.hh"
+#include "flightrecorder.hh"
 #include <QStringList>
+#include <vector>
 
 namespace ScriptEmbedderNS
 {
@@ -39,7 +44,9 @@ public:
      * @return True, if new configuration was successfully set.
      * @pre conf is valid.
      * @post ScriptEmbedder starts working according to the new configuration.
-     * If setting configuration failed, error message is available in errorString().
+     * Setting configuration fails, if a script has an entry point and its
+     * interpreter does not support entry points. If setting configuration
+     * failed, error message is available in errorString().
      * If setting configuration fails, embedder becomes invalid.
      */
     virtual bool reset(const Configuration& conf) = 0;
@@ -76,18 +83,69 @@ public:
      * @param params Parameters to be passed to the script.
      * @pre -
      * @post Script is executed if it does exist. Logger is notified if script
-     * does not exist, and when script finishes or fails.
+     * does not exist, and when script finishes or fails. If script has an
+     * entry point, script is evaluated on its first execution only, and each
+     * execution calls the entry-point function. Each execution takes place
+     * in its own interpreter scope: global state left by previous executions
+     * is not visible to the script. Top-level state of an entry-point script
+     * persists between calls, and is shared with scripts having identical
+     * source (see ScriptEntry::entryPoint).
      */
     virtual void execute(unsigned scriptId,
                          const QStringList& params = QStringList()) = 0;
 
+    /**
+     * @brief Hint that scripts are about to be executed. Sources of scripts
+     * read on demand are read in background, so that their execution does
+     * not wait for storage. Prefetched source is used by the next execution
+     * of the script. If reading has not started by then, the source is read
+     * as if it had not been prefetched.
+     * @param scriptIds Ids of scripts in their expected execution order.
+     * @pre -
+     * @post Reading of sources has been started. Scripts that do not exist,
+     * or whose source is in RAM or cached (see ScriptEntry::checkInterval),
+     * are ignored. Number of prefetched sources is limited: scripts at the
+     * end of a long list are ignored, and sources prefetched earlier but not
+     * yet executed may be dropped. Prefetched source is not used, if script
+     * is executed more than a couple of seconds later.
+     */
+    virtual void prefetch(const std::vector<unsigned>& scriptIds) = 0;
+
+    /**
+     * @brief Enable or disable predictive prefetching. When enabled, the
+     * embedder learns which scripts tend to be executed soon after each
+     * other, and prefetches (see prefetch()) likely successors of each
+     * executed script.
+     * @param enabled True enables prediction. Disabling it forgets learned
+     * history. Disabled by default.
+     * @pre -
+     */
+    virtual void setPredictivePrefetch(bool enabled) = 0;
+
+    /**
+     * @brief Set memory limit for promoting frequently executed scripts to
+     * RAM. Execution frequency of each script read on demand is tracked
+     * with a decaying counter. Hot scripts are kept in RAM, and scripts that
+     * have become cold are dropped. If limit is reached, a script is promoted
+     * only if demoting promoted scripts colder than it frees enough room.
+     * Coldest of them are then demoted. Promoted scripts remain editable: their file status is checked
+     * before each execution (see ScriptEntry::checkInterval). Promotions and
+     * demotions are reported to Logger.
+     * @param memoryLimit Maximum total size of promoted sources in bytes.
+     * 0 disables promotion (default).
+     * @pre memoryLimit >= 0.
+     * @post Promoted scripts exceeding the new limit are demoted.
+     */
+    virtual void setPromotionLimit(qint64 memoryLimit) = 0;
+
     /**
      * @brief Add new script into current configuration.
      * @param script Script to be added.
      * @return True, if script was added successfully.
      * @pre -
-     * @post Script is added to configuration. If script path is invalid
-     * or suitable interpreter has not been set, script is not added
+     * @post Script is added to configuration. If script path is invalid,
+     * suitable interpreter has not been set, or script has an entry point
+     * and the interpreter does not support entry points, script is not added
      * and method returns false. In case of error, error message can be found
      * in errorString(). If there already exists a script with same id, it is
      * replaced. Logger is notified.
@@ -102,6 +160,30 @@ public:
      */
     virtual void removeScript(unsigned scriptId) = 0;
 
+    /**
+     * @brief Add several scripts into current configuration at once.
+     * @param scripts Scripts to be added. If several scripts have the same
+     * id, the last one of them is added.
+     * @return True, if all scripts were added successfully.
+     * @pre -
+     * @post All scripts are validated as in addScript() before any changes
+     * are made. If any of them is invalid, no scripts are added, method
+     * returns false and error message can be found in errorString(). Error
+     * message has a summary line followed by an error for each invalid
+     * script, one per line.
+     * Logger is notified once with a summary.
+     */
+    virtual bool addScripts(const std::vector<ScriptEntry>& scripts) = 0;
+
+    /**
+     * @brief Remove several scripts from current configuration at once.
+     * @param scriptIds Ids of scripts to be removed.
+     * @pre -
+     * @post Scripts are removed from configuration. Logger is notified once
+     * with a summary.
+     */
+    virtual void removeScripts(const std::vector<unsigned>& scriptIds) = 0;
+
     /**
      * @brief Add new interpreter into current configuration.
      * @param interpreter New Interpreter.
@@ -124,6 +206,71 @@ public:
      * disabled.
      */
     virtual void setLogger(Logger* logger) = 0;
+
+    /**
+     * @brief Set batch logger. Script results are buffered and delivered
+     * to the batch logger in batches. Buffered results are delivered when
+     * maxBatchSize results have been buffered, or when a script finishes
+     * or flushExpired() is called, and the oldest buffered result is at
+     * least maxDelay milliseconds old. Embedder has no timer of its own:
+     * if scripts are executed rarely, call flushExpired() periodically, so
+     * that results are not held back longer than maxDelay.
+     * @param logger Logger receiving result batches. Buffered results are
+     * delivered to the previous batch logger before it is replaced.
+     * @param maxBatchSize Maximum number of buffered results.
+     * @param maxDelay Maximum age of buffered results in milliseconds.
+     * @pre maxBatchSize > 0.
+     * @post Batch logger receives results from now on. If logger is nullptr,
+     * results are not buffered. Batch logger does not affect Logger.
+     */
+    virtual void setBatchLogger(BatchLogger* logger,
+                                unsigned maxBatchSize = 256,
+                                unsigned maxDelay = 100) = 0;
+
+    /**
+     * @brief Deliver buffered results to the batch logger immediately.
+     * @pre -
+     * @post Result buffer is empty.
+     */
+    virtual void flushResults() = 0;
+
+    /**
+     * @brief Deliver buffered results to the batch logger, if the oldest of
+     * them is at least maxDelay milliseconds old (see setBatchLogger()).
+     * Intended to be called periodically from the host's event loop.
+     * @pre -
+     * @post Result buffer contains no results older than maxDelay.
+     */
+    virtual void flushExpired() = 0;
+
+    /**
+     * @brief Get execution metrics collected since the embedder was created.
+     * Metrics are collected for existing scripts only, and metrics of a
+     * script are dropped when it is removed. Collecting metrics
+     * uses atomic counters, and this method may be called from any thread.
+     * @return Snapshot of current metrics per script and per language.
+     * @pre -
+     */
+    virtual MetricsSnapshot metrics() const = 0;
+
+    /**
+     * @brief Set execution tracer.
+     * @param tracer Tracer receiving spans of execution phases.
+     * @pre -
+     * @post Tracer receives spans of all following executions. If tracer is
+     * nullptr or this method is never called, executions are not traced.
+     */
+    virtual void setTracer(ExecutionTracer* tracer) = 0;
+
+    /**
+     * @brief Get flight recorder holding compact records of the latest
+     * executions. Records can be dumped on request, or from a signal
+     * handler with FlightRecorder::dump(int).
+     * @return Flight recorder owned by the embedder. Valid as long as the
+     * embedder exists.
+     * @pre -
+     */
+    virtual const FlightRecorder& flightRecorder() const = 0;
 };
 
 } // namespace ScriptEmbedderNS
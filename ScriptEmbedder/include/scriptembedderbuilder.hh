@@ -29,6 +29,21 @@ public:
      * @pre Configuration is valid.
      */
     static ScriptEmbedder* createSerialEmbedder(const Configuration& conf);
+
+    /**
+     * @brief Instantiate ScriptEmbedder that records execute() calls into an
+     * execution trace and forwards all calls to another embedder. Traces
+     * can be replayed with the LoadGenerator tool, see executiontrace.hh.
+     * @param embedder Embedder executing the scripts. Ownership is passed
+     * to the new embedder.
+     * @param tracePath Path of the trace file. Existing file is overwritten.
+     * @return New instance of ScriptEmbedder. Ownership is passed to the caller.
+     * If trace file could not be created, returned embedder is invalid and
+     * error message is available in its errorString().
+     * @pre embedder != nullptr.
+     */
+    static ScriptEmbedder* createRecordingEmbedder(ScriptEmbedder* embedder,
+                                                   const QString& tracePath);
 };
 
 } // namespace ScriptEmbedderNS
@@ -9,6 +9,7 @@
 #ifndef SCRIPTINTERPRETER
 #define SCRIPTINTERPRETER
 
+#include <QByteArray>
 #include <QString>
 #include <QStringList>
 #include <memory>
@@ -81,6 +82,147 @@ public:
     virtual ScriptRunResult runScript(const QString& script,
                                       const QStringList& params) = 0;
 
+    /**
+     * @brief Check if interpreter prefers receiving script sources as UTF-8
+     * bytes. If true, ScriptEmbedder stores sources of this interpreter's
+     * scripts as UTF-8 and passes them to runScriptUtf8() and
+     * prepareScriptUtf8() without converting them to QString.
+     * Default implementation returns false.
+     * @return True, if UTF-8 methods should be used.
+     * @pre -
+     */
+    virtual bool prefersUtf8() const
+    {
+        return false;
+    }
+
+    /**
+     * @brief Run script given as UTF-8 bytes. Otherwise same as runScript().
+     * Default implementation converts the source and calls runScript().
+     * @param script UTF-8 encoded script source. The data may be a view to
+     * a memory-mapped file, and must not be used after this method returns.
+     * @param params Script parameters.
+     * @return Script run results.
+     * @pre ScriptAPI object has been set.
+     */
+    virtual ScriptRunResult runScriptUtf8(const QByteArray& script,
+                                          const QStringList& params)
+    {
+        return this->runScript(QString::fromUtf8(script), params);
+    }
+
+    /**
+     * @brief Enter a new execution scope. ScriptEmbedder calls this before
+     * each script execution. State created by the script (global variables
+     * etc.) should be discarded when leaveExecutionScope() is called, so
+     * that executions do not affect each other. Implementations should make
+     * this cheap compared to running a script. Default implementation does
+     * nothing.
+     * @pre ScriptAPI object has been set.
+     * @post Following script runs take place in the new scope.
+     */
+    virtual void enterExecutionScope()
+    {
+    }
+
+    /**
+     * @brief Leave the scope entered with enterExecutionScope().
+     * Default implementation does nothing.
+     * @pre enterExecutionScope() has been called.
+     * @post State created in the scope has been discarded. Contexts of
+     * prepared scripts (see prepareScript()) are not affected.
+     */
+    virtual void leaveExecutionScope()
+    {
+    }
+
+    /**
+     * @brief Check if interpreter supports the entry-point mode, where script
+     * is evaluated once using prepareScript() and executed by calling one of
+     * its functions using call(). Default implementation returns false.
+     * @return True, if prepareScript(), call() and releaseScript() are supported.
+     * @pre -
+     */
+    virtual bool supportsEntryPoints() const
+    {
+        return false;
+    }
+
+    /**
+     * @brief Evaluate script once into its own persistent context. Functions
+     * and variables defined by the script remain available for call().
+     * Default implementation fails.
+     * @param handle Identifier for the prepared script. If a script has
+     * already been prepared with same handle, it is replaced.
+     * @param script Script source code.
+     * @return SUCCESS, if script was evaluated without errors. Else FAILURE
+     * and error message.
+     * @pre ScriptAPI object has been set. supportsEntryPoints() returns true.
+     */
+    virtual ScriptRunResult prepareScript(unsigned handle, const QString& script)
+    {
+        Q_UNUSED(handle);
+        Q_UNUSED(script);
+        ScriptRunResult result;
+        result.result = FAILURE;
+        result.returnValue = 0;
+        result.errorString = QString("Entry points are not supported.");
+        return result;
+    }
+
+    /**
+     * @brief Prepare script given as UTF-8 bytes. Otherwise same as
+     * prepareScript(). Default implementation converts the source and calls
+     * prepareScript().
+     * @param handle Identifier for the prepared script.
+     * @param script UTF-8 encoded script source. The data may be a view to
+     * a memory-mapped file, and must not be used after this method returns.
+     * @return SUCCESS, if script was evaluated without errors. Else FAILURE
+     * and error message.
+     * @pre ScriptAPI object has been set. supportsEntryPoints() returns true.
+     */
+    virtual ScriptRunResult prepareScriptUtf8(unsigned handle, const QByteArray& script)
+    {
+        return this->prepareScript(handle, QString::fromUtf8(script));
+    }
+
+    /**
+     * @brief Call function defined by a prepared script.
+     * Default implementation fails.
+     * @param handle Handle given in prepareScript().
+     * @param function Name of the called function.
+     * @param args Arguments passed to the function.
+     * @return Function's results containing Result, return value and
+     * possibly error message describing errors.
+     * @pre Script has been prepared with this handle.
+     */
+    virtual ScriptRunResult call(unsigned handle,
+                                 const QString& function,
+                                 const QStringList& args)
+    {
+        Q_UNUSED(handle);
+        Q_UNUSED(function);
+        Q_UNUSED(args);
+        ScriptRunResult result;
+        result.result = FAILURE;
+        result.returnValue = 0;
+        result.errorString = QString("Entry points are not supported.");
+        return result;
+    }
+
+    /**
+     * @brief Release context of a prepared script.
+     * Default implementation does nothing.
+     * @param handle Handle given in prepareScript().
+     * @pre -
+     * @post Resources reserved for the prepared script are released.
+     * If no such script has been prepared, does nothing.
+     */
+    virtual void releaseScript(unsigned handle)
+    {
+        Q_UNUSED(handle);
+    }
+
     /**
      * @brief Get the name of scripting language supported by this interpreter.
      * @return Language name as a string.
@@ -0,0 +1,287 @@
+/**
+ * @file
+ * @brief Implements the AsyncLogger class defined in asynclogger.hh.
+ * @author Perttu Paarlahti 2016.
+ */
+
+#include "asynclogger.hh"
+#include <algorithm>
+#include <chrono>
+
+namespace ScriptEmbedderNS
+{
+
+namespace
+{
+// Unique serial numbers for AsyncLogger instances.
+std::atomic<unsigned long long> nextSerial(1);
+
+// Background thread wakes up at least this often.
+const std::chrono::milliseconds IDLE_TIMEOUT(10);
+}
+
+
+AsyncLogger::AsyncLogger(Logger* target, unsigned ringCapacity) :
+    Logger(),
+    target_(target), ringCapacity_(ringCapacity), serial_(nextSerial++),
+    ringsMutex_(), rings_(), posted_(0), delivered_(0), stop_(false), sleeping_(false),
+    wakeMutex_(), wakeup_(), drained_(), worker_()
+{
+    Q_ASSERT(target != nullptr);
+    Q_ASSERT(ringCapacity > 0);
+    worker_ = std::thread(&AsyncLogger::run, this);
+}
+
+
+AsyncLogger::~AsyncLogger()
+{
+    stop_.store(true);
+    this->wake();
+    worker_.join();
+}
+
+
+void AsyncLogger::flush()
+{
+    // Records are published by advancing ring heads, so everything posted
+    // before this call has been delivered when tails reach current heads.
+    std::vector<std::pair<std::shared_ptr<Ring>, unsigned> > targets;
+    {
+        std::lock_guard<std::mutex> lock(ringsMutex_);
+        for (auto it = rings_.begin(); it != rings_.end(); ++it) {
+            targets.push_back(std::make_pair(*it, (*it)->head.load(std::memory_order_acquire)));
+        }
+    }
+
+    std::unique_lock<std::mutex> lock(wakeMutex_);
+    wakeup_.notify_one();
+    drained_.wait(lock, [&targets]() {
+        for (auto it = targets.begin(); it != targets.end(); ++it) {
+            // Difference handles wrap-around of the counters.
+            unsigned tail = it->first->tail.load(std::memory_order_acquire);
+            if (int(tail - it->second) < 0) return false;
+        }
+        return true;
+    });
+}
+
+
+void AsyncLogger::logMessage(const QString& msg)
+{
+    Record record = Record();
+    record.kind = Record::MESSAGE;
+    record.message = LogMessage(msg);
+    this->post(record);
+}
+
+
+void AsyncLogger::logRecord(const LogMessage& msg)
+{
+    Record record = Record();
+    record.kind = Record::MESSAGE;
+    record.message = msg;
+    this->post(record);
+}
+
+
+void AsyncLogger::scriptExecuted(const ScriptEntry& script,
+                                 const QStringList& params,
+                                 int returnValue)
+{
+    Record record = Record();
+    record.kind = Record::EXECUTED;
+    record.script = script;
+    record.params = params;
+    record.returnValue = returnValue;
+    this->post(record);
+}
+
+
+void AsyncLogger::scriptFailed(const ScriptEntry& script,
+                               const QStringList& params,
+                               const QString& errorMsg)
+{
+    Record record = Record();
+    record.kind = Record::FAILED;
+    record.script = script;
+    record.params = params;
+    record.errorMsg = errorMsg;
+    this->post(record);
+}
+
+
+AsyncLogger::Ring::Ring(unsigned capacity) :
+    slots(), mask(0), head(0), tail(0), closed(false)
+{
+    unsigned size = 1;
+    while (size < capacity) {
+        size <<= 1;
+    }
+    slots.resize(size);
+    mask = size - 1;
+}
+
+
+AsyncLogger::Ring* AsyncLogger::threadRing()
+{
+    // Rings of the calling thread. Logger serial is used as key, so that
+    // rings of destroyed loggers are never matched again. When thread
+    // exits, its rings are closed, so that loggers can release them.
+    struct ThreadRings
+    {
+        std::vector<std::pair<unsigned long long, std::weak_ptr<Ring> > > rings;
+
+        ~ThreadRings()
+        {
+            for (auto it = rings.begin(); it != rings.end(); ++it) {
+                std::shared_ptr<Ring> ring = it->second.lock();
+                if (ring != nullptr) {
+                    ring->closed.store(true, std::memory_order_release);
+                }
+            }
+        }
+    };
+    static thread_local ThreadRings threadRings;
+
+    std::vector<std::pair<unsigned long long, std::weak_ptr<Ring> > >& rings = threadRings.rings;
+    for (auto it = rings.begin(); it != rings.end(); ) {
+        if (it->first == serial_) {
+            // Ring is owned by this logger while the thread is alive.
+            return it->second.lock().get();
+        }
+        if (it->second.expired()) {
+            // Logger has been destroyed.
+            it = rings.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    std::shared_ptr<Ring> ring(new Ring(ringCapacity_));
+    {
+        std::lock_guard<std::mutex> lock(ringsMutex_);
+        rings_.push_back(ring);
+    }
+    rings.push_back(std::make_pair(serial_, std::weak_ptr<Ring>(ring)));
+    return ring.get();
+}
+
+
+void AsyncLogger::post(const Record& record)
+{
+    Ring* ring = this->threadRing();
+    unsigned head = ring->head.load(std::memory_order_relaxed);
+
+    // Wait for the background thread, if ring is full.
+    while (head - ring->tail.load(std::memory_order_acquire) > ring->mask) {
+        this->wake();
+        std::this_thread::yield();
+    }
+
+    ring->slots[head & ring->mask] = record;
+    ring->head.store(head + 1, std::memory_order_release);
+    posted_.fetch_add(1);
+    if (sleeping_.load()) {
+        this->wake();
+    }
+}
+
+
+void AsyncLogger::wake()
+{
+    // Locking ensures that background thread is either waiting or has not
+    // yet checked for new records, so the notification is not lost.
+    { std::lock_guard<std::mutex> lock(wakeMutex_); }
+    wakeup_.notify_one();
+}
+
+
+void AsyncLogger::run()
+{
+    while (true) {
+        // Stop flag is read before draining, so that records posted
+        // before destruction are always delivered.
+        bool stopping = stop_.load();
+        if (this->drain()) {
+            // Wake up flushing threads. Locking ensures that a thread
+            // checking the ring tails is already waiting.
+            { std::lock_guard<std::mutex> lock(wakeMutex_); }
+            drained_.notify_all();
+            continue;
+        }
+        if (stopping) break;
+
+        // Posting threads wake this thread only when it may be sleeping.
+        // Flag is set before checking for new records, so that either the
+        // check sees a new record or its poster sees the flag.
+        std::unique_lock<std::mutex> lock(wakeMutex_);
+        sleeping_.store(true);
+        wakeup_.wait_for(lock, IDLE_TIMEOUT, [this]() {
+            return stop_.load() || posted_.load() != delivered_.load();
+        });
+        sleeping_.store(false);
+    }
+}
+
+
+bool AsyncLogger::drain()
+{
+    std::vector<std::shared_ptr<Ring> > rings;
+    {
+        std::lock_guard<std::mutex> lock(ringsMutex_);
+        rings = rings_;
+    }
+
+    bool delivered = false;
+    std::vector<Ring*> finished;
+    for (auto it = rings.begin(); it != rings.end(); ++it) {
+        Ring* ring = it->get();
+        // Closed ring gets no more records after its current head.
+        bool closed = ring->closed.load(std::memory_order_acquire);
+        unsigned tail = ring->tail.load(std::memory_order_relaxed);
+        unsigned head = ring->head.load(std::memory_order_acquire);
+        if (closed) {
+            finished.push_back(ring);
+        }
+        while (tail != head) {
+            Record& record = ring->slots[tail & ring->mask];
+            this->deliver(record);
+            record = Record(); // Release shared data.
+            ++tail;
+            ring->tail.store(tail, std::memory_order_release);
+            delivered_.fetch_add(1);
+            delivered = true;
+        }
+    }
+
+    // Release rings of exited threads.
+    if (!finished.empty()) {
+        std::lock_guard<std::mutex> lock(ringsMutex_);
+        for (auto it = finished.begin(); it != finished.end(); ++it) {
+            Ring* ring = *it;
+            rings_.erase(std::remove_if(rings_.begin(), rings_.end(),
+                                        [ring](const std::shared_ptr<Ring>& r) {
+                return r.get() == ring;
+            }), rings_.end());
+        }
+    }
+    return delivered;
+}
+
+
+void AsyncLogger::deliver(Record& record)
+{
+    switch (record.kind) {
+    case Record::MESSAGE:
+        target_->logRecord(record.message);
+        break;
+    case Record::EXECUTED:
+        target_->scriptExecuted(record.script, record.params, record.returnValue);
+        break;
+    case Record::FAILED:
+        target_->scriptFailed(record.script, record.params, record.errorMsg);
+        break;
+    }
+}
+
+} // namespace ScriptEmbedderNS
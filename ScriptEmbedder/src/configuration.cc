@@ -8,12 +8,76 @@
 #include "configuration.hh"
 #include <QFileInfo>
 #include <QLibrary>
+#include <QStringList>
+#include <algorithm>
+#include <thread>
 
 namespace ScriptEmbedderNS {
 
+/**
+ * @brief Data shared by copies of a Configuration.
+ */
+class ConfigurationData : public QSharedData
+{
+public:
+    std::shared_ptr<ScriptAPI> api;
+    std::map<QString, InterpreterEntry> interpreters;
+    std::map<unsigned, ScriptEntry> scripts;
+};
+
+
+namespace
+{
+// Smallest number of paths checked by one thread.
+const std::size_t PATHS_PER_THREAD = 512;
+
+/**
+ * @brief Check existence of files. Large number of paths is divided
+ * between several threads, as each check is a separate system call.
+ * @param paths Checked paths.
+ * @return For each path, true if the file exists.
+ */
+std::vector<char> checkPaths(const std::vector<QString>& paths)
+{
+    std::vector<char> exists(paths.size(), 0);
+    auto check = [&paths, &exists](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+            exists[i] = QFileInfo::exists(paths[i]);
+        }
+    };
+
+    std::size_t threads = std::min<std::size_t>(
+                std::max(1u, std::thread::hardware_concurrency()),
+                paths.size() / PATHS_PER_THREAD + 1);
+    std::size_t slice = (paths.size() + threads - 1) / threads;
+    std::vector<std::thread> workers;
+    for (std::size_t i = 1; i < threads; ++i) {
+        std::size_t begin = std::min(paths.size(), i * slice);
+        std::size_t end = std::min(paths.size(), begin + slice);
+        workers.push_back(std::thread(check, begin, end));
+    }
+    check(0, std::min(paths.size(), slice));
+    for (auto it = workers.begin(); it != workers.end(); ++it) {
+        it->join();
+    }
+    return exists;
+}
+}
+
+
+QString ValidationReport::errorString() const
+{
+    QStringList messages;
+    for (auto it = errors.begin(); it != errors.end(); ++it) {
+        messages.append(it->message);
+    }
+    return messages.join('\n');
+}
+
+
 
 Configuration::Configuration() :
-    api_(nullptr), interpreters_(), scripts_()
+    d_(new ConfigurationData())
 {
     Q_ASSERT(!this->isValid());
 }
@@ -22,7 +86,28 @@ Configuration::Configuration() :
 Configuration::Configuration(std::shared_ptr<ScriptAPI> api,
                              std::map<QString, InterpreterEntry> interpreters,
                              std::map<unsigned, ScriptEntry> scripts) :
-    api_(api), interpreters_(interpreters), scripts_(scripts)
+    d_(new ConfigurationData())
+{
+    d_->api = api;
+    d_->interpreters.swap(interpreters);
+    d_->scripts.swap(scripts);
+}
+
+
+Configuration::Configuration(const Configuration& other) :
+    d_(other.d_)
+{
+}
+
+
+Configuration& Configuration::operator=(const Configuration& other)
+{
+    d_ = other.d_;
+    return *this;
+}
+
+
+Configuration::~Configuration()
 {
 }
 
@@ -30,144 +115,150 @@ Configuration::Configuration(std::shared_ptr<ScriptAPI> api,
 void Configuration::setScriptAPI(std::shared_ptr<ScriptAPI> api)
 {
     Q_ASSERT(api != nullptr);
-    api_ = api;
+    d_->api = api;
 }
 
 
 std::shared_ptr<ScriptAPI> Configuration::scriptAPI() const
 {
-    return api_;
+    return d_->api;
 }
 
 
 void Configuration::addInterpreter(const InterpreterEntry& interpreter)
 {
-    interpreters_[interpreter.scriptLanguage] = interpreter;
+    d_->interpreters[interpreter.scriptLanguage] = interpreter;
 }
 
 
 void Configuration::removeInterpreter(const QString& lang)
 {
-    interpreters_.erase(lang);
+    d_->interpreters.erase(lang);
 }
 
 
 bool Configuration::hasInterpreter(const QString& language) const
 {
-    return interpreters_.find(language) != interpreters_.end();
+    return d_->interpreters.find(language) != d_->interpreters.end();
 }
 
 
 InterpreterEntry Configuration::getInterpteter(const QString& language) const
 {
-    auto it = interpreters_.find(language);
-    if (it == interpreters_.end()){
+    auto it = d_->interpreters.find(language);
+    if (it == d_->interpreters.end()){
         return InterpreterEntry();
     }
     return it->second;
 }
 
 
-std::map<QString, InterpreterEntry> Configuration::interpreters() const
+const std::map<QString, InterpreterEntry>& Configuration::interpreters() const
 {
-    return interpreters_;
+    return d_->interpreters;
 }
 
 
 void Configuration::addScript(const ScriptEntry& script)
 {
-    scripts_[script.id] = script;
+    d_->scripts[script.id] = script;
 }
 
 
 void Configuration::removeScript(unsigned id)
 {
-    scripts_.erase(id);
+    d_->scripts.erase(id);
 }
 
 
 bool Configuration::hasScript(unsigned id) const
 {
-    return scripts_.find(id) != scripts_.end();
+    return d_->scripts.find(id) != d_->scripts.end();
 }
 
 
 ScriptEntry Configuration::getScript(unsigned id) const
 {
-    auto it = scripts_.find(id);
-    if (it == scripts_.end()){
+    auto it = d_->scripts.find(id);
+    if (it == d_->scripts.end()){
         return ScriptEntry();
     }
     return it->second;
 }
 
 
-std::map<unsigned, ScriptEntry> Configuration::scripts() const
+const std::map<unsigned, ScriptEntry>& Configuration::scripts() const
 {
-    return scripts_;
+    return d_->scripts;
 }
 
 
 bool Configuration::isValid() const
 {
-    // Check api and number of interpreters.
-    if (api_ == nullptr) return false;
-    if (interpreters_.empty()) return false;
+    return this->validate().isValid();
+}
 
-    // Check script entries.
-    for (auto iter = scripts_.begin(); iter != scripts_.end(); ++iter){
-        if (interpreters_.find(iter->second.scriptLanguage) == interpreters_.end()) {
-            return false;
-        }
-        else if (!QFile::exists(iter->second.scriptPath)){
-            return false;
-        }
-    }
 
-    // Check interpreters
-    for (auto iter = interpreters_.begin(); iter != interpreters_.end(); ++iter) {
-        if (!QLibrary::isLibrary(iter->second.pluginPath)){
-            return false;
-        }
-    }
+QString Configuration::errorString() const
+{
+    ValidationReport report = this->validate();
+    if (report.isValid()) return QString();
 
-    return true;
+    return report.errors.front().message;
 }
 
 
-QString Configuration::errorString() const
+ValidationReport Configuration::validate() const
 {
-    if (this->isValid()) return QString();
-
-    if (api_ == nullptr){
-        return QString("ScriptAPI has not been set.");
+    ValidationReport report;
+    if (d_->api == nullptr){
+        report.errors.push_back({ValidationReport::Error::NO_SCRIPT_API, 0u,
+                                 QString("ScriptAPI has not been set.")});
     }
-    if (interpreters_.empty()){
-        return QString("At liest one interpreter has to be set.");
+    if (d_->interpreters.empty()){
+        report.errors.push_back({ValidationReport::Error::NO_INTERPRETERS, 0u,
+                                 QString("At liest one interpreter has to be set.")});
     }
-    for (auto iter = scripts_.begin(); iter != scripts_.end(); ++iter) {
-        if (!QFileInfo::exists(iter->second.scriptPath)){
-            return QString("Path (%1) for script(id=%2) is invalid.")
-                    .arg(iter->second.scriptPath).arg(iter->second.id);
+
+    // Check each distinct script path only once. Scripts often share files.
+    std::map<QString, std::size_t> pathIndex;
+    std::vector<QString> paths;
+    for (auto iter = d_->scripts.begin(); iter != d_->scripts.end(); ++iter) {
+        if (iter->second.isInline()) continue;
+
+        if (pathIndex.insert(std::make_pair(iter->second.scriptPath, paths.size())).second) {
+            paths.push_back(iter->second.scriptPath);
         }
-        if (interpreters_.find(iter->second.scriptLanguage) == interpreters_.end()) {
-            return QString("No suitable interpreter for '%1' required by script(id=%2).")
-                    .arg(iter->second.scriptLanguage).arg(iter->second.id);
+    }
+    std::vector<char> exists = checkPaths(paths);
+
+    for (auto iter = d_->scripts.begin(); iter != d_->scripts.end(); ++iter) {
+        if (!iter->second.isInline() && !exists[pathIndex[iter->second.scriptPath]]){
+            report.errors.push_back({ValidationReport::Error::INVALID_SCRIPT_PATH, iter->first,
+                                     QString("Path (%1) for script(id=%2) is invalid.")
+                                     .arg(iter->second.scriptPath).arg(iter->second.id)});
+        }
+        if (d_->interpreters.find(iter->second.scriptLanguage) == d_->interpreters.end()) {
+            report.errors.push_back({ValidationReport::Error::NO_SUITABLE_INTERPRETER, iter->first,
+                                     QString("No suitable interpreter for '%1' required by script(id=%2).")
+                                     .arg(iter->second.scriptLanguage).arg(iter->second.id)});
         }
     }
-    for (auto iter = interpreters_.begin(); iter != interpreters_.end(); ++iter) {
+    for (auto iter = d_->interpreters.begin(); iter != d_->interpreters.end(); ++iter) {
         if (!QLibrary::isLibrary(iter->second.pluginPath)) {
-            return QString("Invalid interpreter plugin path: '%1'.").arg(iter->second.pluginPath);
+            report.errors.push_back({ValidationReport::Error::INVALID_PLUGIN_PATH, 0u,
+                                     QString("Invalid interpreter plugin path: '%1'.")
+                                     .arg(iter->second.pluginPath)});
         }
     }
 
-    Q_ASSERT(false);  // This should never be executed.
-    return QString(); // Suppress warnings.
+    return report;
 }
 
 
 ScriptEntry::ScriptEntry() :
-    id(0), scriptPath(), scriptLanguage(), readToRAM(false), priority(0)
+    id(0), scriptPath(), scriptLanguage(), readToRAM(false), priority(0),
+    entryPoint(), storage(COPY), source(), checkInterval(-1)
 {
 }
 
@@ -176,23 +267,63 @@ ScriptEntry::ScriptEntry(unsigned scriptId,
                          const QString& path,
                          const QString& language,
                          bool toRAM,
-                         unsigned priority) :
+                         unsigned priority,
+                         const QString& entryPoint,
+                         Storage storage) :
 
     id(scriptId), scriptPath(path), scriptLanguage(language),
-    readToRAM(toRAM), priority(priority)
+    readToRAM(toRAM), priority(priority), entryPoint(entryPoint),
+    storage(storage), source(), checkInterval(-1)
 {
     Q_ASSERT(!path.isEmpty());
     Q_ASSERT(!language.isEmpty());
 }
 
 
+ScriptEntry ScriptEntry::fromSource(unsigned scriptId,
+                                    const QString& source,
+                                    const QString& language,
+                                    unsigned priority,
+                                    const QString& entryPoint,
+                                    Storage storage)
+{
+    Q_ASSERT(!source.isEmpty());
+    Q_ASSERT(!language.isEmpty());
+    ScriptEntry script;
+    script.id = scriptId;
+    script.scriptLanguage = language;
+    script.readToRAM = true;
+    script.priority = priority;
+    script.entryPoint = entryPoint;
+    script.storage = storage;
+    script.source = source;
+    return script;
+}
+
+
+bool ScriptEntry::isInline() const
+{
+    return !source.isEmpty();
+}
+
+
+bool ScriptEntry::isCached() const
+{
+    return !readToRAM && !this->isInline() && checkInterval >= 0;
+}
+
+
 bool ScriptEntry::operator==(const ScriptEntry& rhs) const
 {
     return this->id == rhs.id &&
             this->scriptLanguage == rhs.scriptLanguage &&
             this->scriptPath == rhs.scriptPath &&
             this->readToRAM == rhs.readToRAM &&
-            this->priority == rhs.priority;
+            this->priority == rhs.priority &&
+            this->entryPoint == rhs.entryPoint &&
+            this->storage == rhs.storage &&
+            this->source == rhs.source &&
+            this->checkInterval == rhs.checkInterval;
 }
 
 
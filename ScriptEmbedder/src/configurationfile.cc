@@ -0,0 +1,519 @@
+/**
+ * @file
+ * @brief Implements the ConfigurationFile class defined in configurationfile.hh.
+ * @author Perttu Paarlahti 2016.
+ */
+
+#include "configurationfile.hh"
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <QtEndian>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace ScriptEmbedderNS
+{
+
+namespace
+{
+const char MAGIC[] = "SECF";
+const quint32 VERSION = 3;
+
+// Sizes of the file sections' elements in bytes.
+const qint64 HEADER_SIZE = 24;
+const qint64 INTERPRETER_SIZE = 8;
+const qint64 SCRIPT_SIZE = 32;
+const qint64 STRING_SIZE = 8;
+
+const quint32 READ_TO_RAM_FLAG = 0x1;
+const quint32 STORAGE_SHIFT = 1;
+const quint32 STORAGE_MASK = 0x3;
+
+const char* const STORAGE_NAMES[] = {"copy", "mapped", "compressed"};
+const unsigned STORAGE_COUNT = sizeof(STORAGE_NAMES) / sizeof(STORAGE_NAMES[0]);
+
+quint32 read32(const uchar* data)
+{
+    return qFromLittleEndian<quint32>(data);
+}
+
+void append32(QByteArray& buffer, quint32 value)
+{
+    uchar bytes[4];
+    qToLittleEndian<quint32>(value, bytes);
+    buffer.append(reinterpret_cast<const char*>(bytes), 4);
+}
+
+bool isUnsigned(const QJsonValue& value)
+{
+    double number = value.toDouble(-1.0);
+    return value.isDouble() && number >= 0.0 &&
+            number <= double(std::numeric_limits<unsigned>::max()) &&
+            std::floor(number) == number;
+}
+
+bool isInt(const QJsonValue& value)
+{
+    double number = value.toDouble(0.5);
+    return value.isDouble() && number >= double(std::numeric_limits<int>::min()) &&
+            number <= double(std::numeric_limits<int>::max()) &&
+            std::floor(number) == number;
+}
+}
+
+
+ConfigurationFile::ConfigurationFile() :
+    file_(), data_(nullptr), size_(0),
+    interpreterCount_(0), scriptCount_(0), stringCount_(0),
+    interpreters_(nullptr), scripts_(nullptr), strings_(nullptr), stringData_(nullptr),
+    errorStr_()
+{
+}
+
+
+ConfigurationFile::~ConfigurationFile()
+{
+    this->close();
+}
+
+
+bool ConfigurationFile::open(const QString& path)
+{
+    this->close();
+    errorStr_.clear();
+    if (!this->mapFile(path)) {
+        this->close();
+        return false;
+    }
+    return true;
+}
+
+
+void ConfigurationFile::close()
+{
+    if (data_ != nullptr) {
+        file_.unmap(const_cast<uchar*>(data_));
+    }
+    file_.close();
+    data_ = nullptr;
+    size_ = 0;
+    interpreterCount_ = 0;
+    scriptCount_ = 0;
+    stringCount_ = 0;
+    interpreters_ = nullptr;
+    scripts_ = nullptr;
+    strings_ = nullptr;
+    stringData_ = nullptr;
+}
+
+
+bool ConfigurationFile::mapFile(const QString& path)
+{
+    file_.setFileName(path);
+    if (!file_.open(QFile::ReadOnly)) {
+        return this->fail(QString("Could not open configuration file '%1': %2")
+                          .arg(path).arg(file_.errorString()));
+    }
+    size_ = file_.size();
+    if (size_ < HEADER_SIZE) {
+        return this->fail(QString("File '%1' is not a configuration file.").arg(path));
+    }
+    data_ = file_.map(0, size_);
+    if (data_ == nullptr) {
+        return this->fail(QString("Could not map configuration file '%1': %2")
+                          .arg(path).arg(file_.errorString()));
+    }
+
+    // Check header and section sizes.
+    if (memcmp(data_, MAGIC, 4) != 0) {
+        return this->fail(QString("File '%1' is not a configuration file.").arg(path));
+    }
+    if (read32(data_ + 4) != VERSION) {
+        return this->fail(QString("Unsupported version (%1) of configuration file '%2'.")
+                          .arg(read32(data_ + 4)).arg(path));
+    }
+    interpreterCount_ = read32(data_ + 8);
+    scriptCount_ = read32(data_ + 12);
+    stringCount_ = read32(data_ + 16);
+    qint64 stringDataOffset = read32(data_ + 20);
+    qint64 tableEnd = HEADER_SIZE + interpreterCount_ * INTERPRETER_SIZE +
+            scriptCount_ * SCRIPT_SIZE + stringCount_ * STRING_SIZE;
+    if (tableEnd > stringDataOffset || stringDataOffset > size_) {
+        return this->fail(QString("Configuration file '%1' is corrupted.").arg(path));
+    }
+    interpreters_ = data_ + HEADER_SIZE;
+    scripts_ = interpreters_ + interpreterCount_ * INTERPRETER_SIZE;
+    strings_ = scripts_ + scriptCount_ * SCRIPT_SIZE;
+    stringData_ = data_ + stringDataOffset;
+
+    // Check references, so that accessing entries needs no checks.
+    qint64 stringDataSize = size_ - stringDataOffset;
+    for (quint32 i = 0; i < stringCount_; ++i) {
+        const uchar* string = strings_ + i * STRING_SIZE;
+        if (qint64(read32(string)) + read32(string + 4) > stringDataSize) {
+            return this->fail(QString("Configuration file '%1' is corrupted.").arg(path));
+        }
+    }
+    for (quint32 i = 0; i < interpreterCount_; ++i) {
+        const uchar* entry = interpreters_ + i * INTERPRETER_SIZE;
+        if (read32(entry) >= stringCount_ || read32(entry + 4) >= stringCount_) {
+            return this->fail(QString("Configuration file '%1' is corrupted.").arg(path));
+        }
+    }
+    for (quint32 i = 0; i < scriptCount_; ++i) {
+        const uchar* entry = scripts_ + i * SCRIPT_SIZE;
+        quint32 entryPoint = read32(entry + 12);
+        quint32 storage = (read32(entry + 20) >> STORAGE_SHIFT) & STORAGE_MASK;
+        quint32 source = read32(entry + 24);
+        bool sorted = i == 0 || read32(entry - SCRIPT_SIZE) < read32(entry);
+        if (!sorted || read32(entry + 4) >= stringCount_ || read32(entry + 8) >= stringCount_ ||
+                (entryPoint != NO_STRING && entryPoint >= stringCount_) ||
+                (source != NO_STRING && source >= stringCount_) ||
+                storage >= STORAGE_COUNT) {
+            return this->fail(QString("Configuration file '%1' is corrupted.").arg(path));
+        }
+    }
+    return true;
+}
+
+
+bool ConfigurationFile::isOpen() const
+{
+    return data_ != nullptr;
+}
+
+
+unsigned ConfigurationFile::interpreterCount() const
+{
+    Q_ASSERT(this->isOpen());
+    return interpreterCount_;
+}
+
+
+InterpreterEntry ConfigurationFile::interpreter(unsigned index) const
+{
+    Q_ASSERT(this->isOpen());
+    Q_ASSERT(index < interpreterCount_);
+    const uchar* entry = interpreters_ + index * INTERPRETER_SIZE;
+    InterpreterEntry interpreter;
+    interpreter.scriptLanguage = this->string(read32(entry), nullptr);
+    interpreter.pluginPath = this->string(read32(entry + 4), nullptr);
+    return interpreter;
+}
+
+
+unsigned ConfigurationFile::scriptCount() const
+{
+    Q_ASSERT(this->isOpen());
+    return scriptCount_;
+}
+
+
+ScriptEntry ConfigurationFile::script(unsigned index) const
+{
+    Q_ASSERT(this->isOpen());
+    Q_ASSERT(index < scriptCount_);
+    return this->decodeScript(scripts_ + index * SCRIPT_SIZE, nullptr);
+}
+
+
+bool ConfigurationFile::findScript(unsigned id, ScriptEntry& script) const
+{
+    Q_ASSERT(this->isOpen());
+    quint32 first = 0;
+    quint32 last = scriptCount_;
+    while (first < last) {
+        quint32 middle = first + (last - first) / 2;
+        const uchar* entry = scripts_ + middle * SCRIPT_SIZE;
+        quint32 entryId = read32(entry);
+        if (entryId == id) {
+            script = this->decodeScript(entry, nullptr);
+            return true;
+        }
+        else if (entryId < id) {
+            first = middle + 1;
+        }
+        else {
+            last = middle;
+        }
+    }
+    return false;
+}
+
+
+Configuration ConfigurationFile::toConfiguration(std::shared_ptr<ScriptAPI> api) const
+{
+    Q_ASSERT(this->isOpen());
+    std::vector<QString> cache(stringCount_);
+
+    std::map<QString, InterpreterEntry> interpreters;
+    for (quint32 i = 0; i < interpreterCount_; ++i) {
+        const uchar* entry = interpreters_ + i * INTERPRETER_SIZE;
+        InterpreterEntry interpreter;
+        interpreter.scriptLanguage = this->string(read32(entry), &cache);
+        interpreter.pluginPath = this->string(read32(entry + 4), &cache);
+        interpreters[interpreter.scriptLanguage] = interpreter;
+    }
+
+    // Entries are sorted, so each one is inserted at the end of the map.
+    std::map<unsigned, ScriptEntry> scripts;
+    for (quint32 i = 0; i < scriptCount_; ++i) {
+        ScriptEntry script = this->decodeScript(scripts_ + i * SCRIPT_SIZE, &cache);
+        scripts.insert(scripts.end(), std::make_pair(script.id, script));
+    }
+
+    return Configuration(api, interpreters, scripts);
+}
+
+
+bool ConfigurationFile::save(const Configuration& conf, const QString& path)
+{
+    errorStr_.clear();
+
+    // Collect distinct strings.
+    QHash<QString, quint32> indices;
+    std::vector<QByteArray> strings;
+    auto intern = [&indices, &strings](const QString& str) -> quint32 {
+        auto it = indices.find(str);
+        if (it != indices.end()) return it.value();
+
+        quint32 index = quint32(strings.size());
+        indices.insert(str, index);
+        strings.push_back(str.toUtf8());
+        return index;
+    };
+
+    const std::map<QString, InterpreterEntry>& interpreters = conf.interpreters();
+    const std::map<unsigned, ScriptEntry>& scripts = conf.scripts();
+    QByteArray entries;
+    entries.reserve(int(interpreters.size() * INTERPRETER_SIZE + scripts.size() * SCRIPT_SIZE));
+    for (auto it = interpreters.begin(); it != interpreters.end(); ++it) {
+        append32(entries, intern(it->second.scriptLanguage));
+        append32(entries, intern(it->second.pluginPath));
+    }
+    for (auto it = scripts.begin(); it != scripts.end(); ++it) {
+        const ScriptEntry& script = it->second;
+        append32(entries, script.id);
+        append32(entries, intern(script.scriptPath));
+        append32(entries, intern(script.scriptLanguage));
+        append32(entries, script.entryPoint.isEmpty() ? NO_STRING : intern(script.entryPoint));
+        append32(entries, script.priority);
+        append32(entries, (script.readToRAM ? READ_TO_RAM_FLAG : 0) |
+                 (quint32(script.storage) << STORAGE_SHIFT));
+        append32(entries, script.isInline() ? intern(script.source) : NO_STRING);
+        append32(entries, quint32(script.checkInterval));
+    }
+
+    QByteArray table;
+    QByteArray stringData;
+    table.reserve(int(strings.size() * STRING_SIZE));
+    for (auto it = strings.begin(); it != strings.end(); ++it) {
+        append32(table, quint32(stringData.size()));
+        append32(table, quint32(it->size()));
+        stringData.append(*it);
+    }
+
+    QByteArray header(MAGIC, 4);
+    append32(header, VERSION);
+    append32(header, quint32(interpreters.size()));
+    append32(header, quint32(scripts.size()));
+    append32(header, quint32(strings.size()));
+    append32(header, quint32(HEADER_SIZE + entries.size() + table.size()));
+
+    // Write into a temporary file and rename it, so that processes having
+    // the old file mapped are not affected.
+    QSaveFile f(path);
+    if (!f.open(QFile::WriteOnly)) {
+        return this->fail(QString("Could not create configuration file '%1': %2")
+                          .arg(path).arg(f.errorString()));
+    }
+    f.write(header);
+    f.write(entries);
+    f.write(table);
+    f.write(stringData);
+    if (!f.commit()) {
+        return this->fail(QString("Could not write configuration file '%1': %2")
+                          .arg(path).arg(f.errorString()));
+    }
+    return true;
+}
+
+
+bool ConfigurationFile::fromJson(const QByteArray& json, Configuration& conf)
+{
+    errorStr_.clear();
+    QJsonParseError parseError;
+    QJsonDocument doc = QJsonDocument::fromJson(json, &parseError);
+    if (parseError.error != QJsonParseError::NoError) {
+        return this->fail(QString("Invalid JSON at offset %1: %2.")
+                          .arg(parseError.offset).arg(parseError.errorString()));
+    }
+    if (!doc.isObject()) {
+        return this->fail("JSON document must be an object.");
+    }
+
+    // Parse all entries before modifying the configuration.
+    std::vector<InterpreterEntry> interpreters;
+    QJsonArray array = doc.object().value("interpreters").toArray();
+    for (int i = 0; i < array.size(); ++i) {
+        QJsonObject obj = array.at(i).toObject();
+        QString language = obj.value("language").toString();
+        QString plugin = obj.value("plugin").toString();
+        if (language.isEmpty() || plugin.isEmpty()) {
+            return this->fail(QString("Interpreter %1 must have non-empty "
+                                      "'language' and 'plugin'.").arg(i));
+        }
+        interpreters.push_back(InterpreterEntry(language, plugin));
+    }
+
+    std::vector<ScriptEntry> scripts;
+    array = doc.object().value("scripts").toArray();
+    for (int i = 0; i < array.size(); ++i) {
+        QJsonObject obj = array.at(i).toObject();
+        QString path = obj.value("path").toString();
+        QString source = obj.value("source").toString();
+        QString language = obj.value("language").toString();
+        QJsonValue priority = obj.value("priority");
+        QJsonValue checkInterval = obj.value("checkInterval");
+        if (!isUnsigned(obj.value("id")) || (path.isEmpty() && source.isEmpty()) ||
+                language.isEmpty()) {
+            return this->fail(QString("Script %1 must have 'id', non-empty 'language', "
+                                      "and non-empty 'path' or 'source'.").arg(i));
+        }
+        if (!priority.isUndefined() && !isUnsigned(priority)) {
+            return this->fail(QString("Script %1 has invalid 'priority'. It must be "
+                                      "a non-negative integer.").arg(i));
+        }
+        if (!checkInterval.isUndefined() && !isInt(checkInterval)) {
+            return this->fail(QString("Script %1 has invalid 'checkInterval'. It must be "
+                                      "an integer.").arg(i));
+        }
+        QString storageName = obj.value("storage").toString(STORAGE_NAMES[0]);
+        unsigned storage = 0;
+        while (storage < STORAGE_COUNT && storageName != STORAGE_NAMES[storage]) {
+            ++storage;
+        }
+        if (storage == STORAGE_COUNT) {
+            return this->fail(QString("Script %1 has unknown storage '%2'.")
+                              .arg(i).arg(storageName));
+        }
+        ScriptEntry script;
+        script.id = unsigned(obj.value("id").toDouble());
+        script.scriptPath = path;
+        script.scriptLanguage = language;
+        script.readToRAM = obj.value("readToRAM").toBool(!source.isEmpty());
+        script.priority = unsigned(priority.toDouble(0.0));
+        script.entryPoint = obj.value("entryPoint").toString();
+        script.storage = ScriptEntry::Storage(storage);
+        script.source = source;
+        script.checkInterval = int(checkInterval.toDouble(-1.0));
+        scripts.push_back(script);
+    }
+
+    for (auto it = interpreters.begin(); it != interpreters.end(); ++it) {
+        conf.addInterpreter(*it);
+    }
+    for (auto it = scripts.begin(); it != scripts.end(); ++it) {
+        conf.addScript(*it);
+    }
+    return true;
+}
+
+
+QByteArray ConfigurationFile::toJson(const Configuration& conf)
+{
+    QJsonArray interpreters;
+    for (auto it = conf.interpreters().begin(); it != conf.interpreters().end(); ++it) {
+        QJsonObject obj;
+        obj.insert("language", it->second.scriptLanguage);
+        obj.insert("plugin", it->second.pluginPath);
+        interpreters.append(obj);
+    }
+
+    QJsonArray scripts;
+    for (auto it = conf.scripts().begin(); it != conf.scripts().end(); ++it) {
+        const ScriptEntry& script = it->second;
+        QJsonObject obj;
+        obj.insert("id", double(script.id));
+        if (!script.scriptPath.isEmpty()) {
+            obj.insert("path", script.scriptPath);
+        }
+        if (script.isInline()) {
+            obj.insert("source", script.source);
+        }
+        obj.insert("language", script.scriptLanguage);
+        obj.insert("readToRAM", script.readToRAM);
+        obj.insert("priority", double(script.priority));
+        obj.insert("storage", QString(STORAGE_NAMES[script.storage]));
+        if (!script.entryPoint.isEmpty()) {
+            obj.insert("entryPoint", script.entryPoint);
+        }
+        if (script.checkInterval != -1) {
+            obj.insert("checkInterval", script.checkInterval);
+        }
+        scripts.append(obj);
+    }
+
+    QJsonObject root;
+    root.insert("interpreters", interpreters);
+    root.insert("scripts", scripts);
+    return QJsonDocument(root).toJson(QJsonDocument::Indented);
+}
+
+
+QString ConfigurationFile::errorString() const
+{
+    return errorStr_;
+}
+
+
+QString ConfigurationFile::string(quint32 index, std::vector<QString>* cache) const
+{
+    if (cache != nullptr && !(*cache)[index].isNull()) {
+        return (*cache)[index];
+    }
+
+    const uchar* string = strings_ + index * STRING_SIZE;
+    QString str = QString::fromUtf8(reinterpret_cast<const char*>(stringData_ + read32(string)),
+                                    int(read32(string + 4)));
+    if (cache != nullptr) {
+        (*cache)[index] = str;
+    }
+    return str;
+}
+
+
+ScriptEntry ConfigurationFile::decodeScript(const uchar* entry, std::vector<QString>* cache) const
+{
+    ScriptEntry script;
+    script.id = read32(entry);
+    script.scriptPath = this->string(read32(entry + 4), cache);
+    script.scriptLanguage = this->string(read32(entry + 8), cache);
+    quint32 entryPoint = read32(entry + 12);
+    if (entryPoint != NO_STRING) {
+        script.entryPoint = this->string(entryPoint, cache);
+    }
+    script.priority = read32(entry + 16);
+    quint32 flags = read32(entry + 20);
+    script.readToRAM = (flags & READ_TO_RAM_FLAG) != 0;
+    script.storage = ScriptEntry::Storage((flags >> STORAGE_SHIFT) & STORAGE_MASK);
+    quint32 source = read32(entry + 24);
+    if (source != NO_STRING) {
+        script.source = this->string(source, cache);
+    }
+    script.checkInterval = int(read32(entry + 28));
+    return script;
+}
+
+
+bool ConfigurationFile::fail(const QString& msg)
+{
+    errorStr_ = msg;
+    return false;
+}
+
+} // namespace ScriptEmbedderNS
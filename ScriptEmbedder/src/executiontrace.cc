@@ -0,0 +1,235 @@
+/**
+ * @file
+ * @brief Implements the ExecutionTraceWriter and ExecutionTraceReader
+ * classes defined in executiontrace.hh.
+ * @author Perttu Paarlahti 2016.
+ */
+
+#include "executiontrace.hh"
+
+namespace ScriptEmbedderNS
+{
+
+namespace
+{
+const char MAGIC[] = "SETR";
+const int MAGIC_SIZE = 4;
+const char VERSION = 1;
+
+// Buffered events are written when buffer grows this large.
+const int BLOCK_SIZE = 64 * 1024;
+
+void appendVarint(QByteArray& buffer, quint64 value)
+{
+    while (value >= 0x80) {
+        buffer.append(char((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    buffer.append(char(value));
+}
+}
+
+
+ExecutionTraceWriter::ExecutionTraceWriter() :
+    file_(), buffer_(), previous_(0), errorStr_()
+{
+}
+
+
+ExecutionTraceWriter::~ExecutionTraceWriter()
+{
+    this->close();
+}
+
+
+bool ExecutionTraceWriter::open(const QString& path)
+{
+    Q_ASSERT(!this->isOpen());
+    file_.setFileName(path);
+    if (!file_.open(QFile::WriteOnly | QFile::Truncate)) {
+        errorStr_ = QString("Could not create trace file '%1': %2")
+                .arg(path).arg(file_.errorString());
+        return false;
+    }
+
+    buffer_.clear();
+    buffer_.reserve(BLOCK_SIZE);
+    buffer_.append(MAGIC, MAGIC_SIZE);
+    buffer_.append(VERSION);
+    previous_ = 0;
+    errorStr_.clear();
+    return true;
+}
+
+
+bool ExecutionTraceWriter::isOpen() const
+{
+    return file_.isOpen();
+}
+
+
+bool ExecutionTraceWriter::write(const TraceEvent& event)
+{
+    Q_ASSERT(this->isOpen());
+    qint64 timestamp = qMax(event.timestamp, previous_);
+    appendVarint(buffer_, quint64(timestamp - previous_));
+    previous_ = timestamp;
+
+    appendVarint(buffer_, event.scriptId);
+    appendVarint(buffer_, quint64(event.params.size()));
+    for (auto it = event.params.begin(); it != event.params.end(); ++it) {
+        QByteArray param = it->toUtf8();
+        appendVarint(buffer_, quint64(param.size()));
+        buffer_.append(param);
+    }
+
+    if (buffer_.size() >= BLOCK_SIZE) {
+        return this->flush();
+    }
+    return true;
+}
+
+
+bool ExecutionTraceWriter::close()
+{
+    if (!this->isOpen()) return true;
+
+    bool ok = this->flush();
+    file_.close();
+    return ok;
+}
+
+
+QString ExecutionTraceWriter::errorString() const
+{
+    return errorStr_;
+}
+
+
+bool ExecutionTraceWriter::flush()
+{
+    if (buffer_.isEmpty()) return true;
+
+    bool ok = file_.write(buffer_) == buffer_.size();
+    buffer_.clear();
+    if (!ok) {
+        errorStr_ = QString("Could not write trace file '%1': %2")
+                .arg(file_.fileName()).arg(file_.errorString());
+    }
+    return ok;
+}
+
+
+ExecutionTraceReader::ExecutionTraceReader() :
+    file_(), data_(), position_(0), offset_(0), previous_(0), errorStr_()
+{
+}
+
+
+bool ExecutionTraceReader::open(const QString& path)
+{
+    file_.close();
+    data_.clear();
+    position_ = 0;
+    offset_ = 0;
+    previous_ = 0;
+    errorStr_.clear();
+
+    file_.setFileName(path);
+    if (!file_.open(QFile::ReadOnly)) {
+        errorStr_ = QString("Could not open trace file '%1': %2")
+                .arg(path).arg(file_.errorString());
+        return false;
+    }
+
+    if (!this->fill(MAGIC_SIZE + 1) || !data_.startsWith(MAGIC)) {
+        errorStr_ = QString("File '%1' is not an execution trace.").arg(path);
+        file_.close();
+        return false;
+    }
+    if (data_.at(MAGIC_SIZE) != VERSION) {
+        errorStr_ = QString("Unsupported version (%1) of trace file '%2'.")
+                .arg(int(data_.at(MAGIC_SIZE))).arg(path);
+        file_.close();
+        return false;
+    }
+
+    position_ = MAGIC_SIZE + 1;
+    return true;
+}
+
+
+bool ExecutionTraceReader::next(TraceEvent& event)
+{
+    if (!this->fill(1)) return false;
+
+    qint64 start = offset_ + position_;
+    quint64 delta = 0;
+    quint64 scriptId = 0;
+    quint64 paramCount = 0;
+    if (!this->readVarint(delta) ||
+            !this->readVarint(scriptId) ||
+            !this->readVarint(paramCount)) {
+        errorStr_ = QString("Truncated trace event at offset %1.").arg(start);
+        return false;
+    }
+
+    event.timestamp = previous_ + qint64(delta);
+    event.scriptId = unsigned(scriptId);
+    event.params.clear();
+    for (quint64 i = 0; i < paramCount; ++i) {
+        quint64 length = 0;
+        // Length is checked against the rest of the file before reading.
+        if (!this->readVarint(length) ||
+                length > quint64(file_.size() - file_.pos() + data_.size() - position_) ||
+                !this->fill(int(length))) {
+            errorStr_ = QString("Truncated trace event at offset %1.").arg(start);
+            return false;
+        }
+        event.params.append(QString::fromUtf8(data_.constData() + position_, int(length)));
+        position_ += int(length);
+    }
+
+    previous_ = event.timestamp;
+    return true;
+}
+
+
+QString ExecutionTraceReader::errorString() const
+{
+    return errorStr_;
+}
+
+
+bool ExecutionTraceReader::fill(int size)
+{
+    if (data_.size() - position_ >= size) return true;
+    if (!file_.isOpen()) return false;
+
+    // Drop the read part, and append blocks until size bytes are available.
+    data_.remove(0, position_);
+    offset_ += position_;
+    position_ = 0;
+    while (data_.size() < size) {
+        QByteArray block = file_.read(qMax(BLOCK_SIZE, size - data_.size()));
+        if (block.isEmpty()) return false;
+        data_.append(block);
+    }
+    return true;
+}
+
+
+bool ExecutionTraceReader::readVarint(quint64& value)
+{
+    value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (!this->fill(1)) return false;
+
+        quint8 byte = quint8(data_.at(position_++));
+        value |= quint64(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0) return true;
+    }
+    return false;
+}
+
+} // namespace ScriptEmbedderNS
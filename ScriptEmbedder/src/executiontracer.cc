@@ -0,0 +1,197 @@
+/**
+ * @file
+ * @brief Implements the ExecutionTracer class defined in executiontracer.hh.
+ * @author Perttu Paarlahti 2016.
+ */
+
+#include "executiontracer.hh"
+#include <atomic>
+#include <QCoreApplication>
+#include <QFile>
+
+namespace ScriptEmbedderNS
+{
+
+namespace
+{
+// Small thread numbers are easier to read in trace viewers than native ids.
+std::atomic<unsigned> nextThread(1);
+
+unsigned currentThread()
+{
+    thread_local unsigned thread = nextThread++;
+    return thread;
+}
+
+// Trace-event timestamps are microseconds.
+QByteArray microseconds(qint64 nanoseconds)
+{
+    return QByteArray::number(double(nanoseconds) / 1000.0, 'f', 3);
+}
+
+// Contents of a JSON string: quotes, backslashes and control characters
+// are escaped.
+QByteArray jsonEscaped(const QString& text)
+{
+    QByteArray utf8 = text.toUtf8();
+    QByteArray escaped;
+    escaped.reserve(utf8.size());
+    for (int i = 0; i < utf8.size(); ++i) {
+        char c = utf8.at(i);
+        switch (c) {
+        case '"':  escaped += "\\\""; break;
+        case '\\': escaped += "\\\\"; break;
+        case '\n': escaped += "\\n"; break;
+        case '\r': escaped += "\\r"; break;
+        case '\t': escaped += "\\t"; break;
+        default:
+            if (uchar(c) < 0x20) {
+                escaped += "\\u00";
+                escaped += QByteArray::number(uchar(c), 16).rightJustified(2, '0');
+            } else {
+                escaped += c;
+            }
+        }
+    }
+    return escaped;
+}
+}
+
+
+ExecutionTracer::ExecutionTracer(unsigned capacity, const QString& outputPath) :
+    clock_(), outputPath_(outputPath), mutex_(), spans_(), capacity_(capacity),
+    next_(0), dropped_(0)
+{
+    Q_ASSERT(capacity > 0);
+    spans_.reserve(capacity);
+    clock_.start();
+}
+
+
+ExecutionTracer::~ExecutionTracer()
+{
+    if (!outputPath_.isEmpty()) {
+        this->dump(outputPath_);
+    }
+}
+
+
+qint64 ExecutionTracer::now() const
+{
+    return clock_.nsecsElapsed();
+}
+
+
+void ExecutionTracer::record(Phase phase,
+                             unsigned scriptId,
+                             const ScriptInterpreter* interpreter,
+                             const QString& language,
+                             qint64 begin,
+                             qint64 end)
+{
+    Q_ASSERT(begin <= end);
+    Span span;
+    span.phase = phase;
+    span.scriptId = scriptId;
+    span.interpreter = interpreter;
+    span.language = language;
+    span.thread = currentThread();
+    span.begin = begin;
+    span.end = end;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (spans_.size() < capacity_) {
+        spans_.push_back(span);
+        return;
+    }
+    spans_[next_] = span;
+    next_ = (next_ + 1) % capacity_;
+    ++dropped_;
+}
+
+
+std::vector<ExecutionTracer::Span> ExecutionTracer::spans() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<Span> spans;
+    spans.reserve(spans_.size());
+    spans.insert(spans.end(), spans_.begin() + next_, spans_.end());
+    spans.insert(spans.end(), spans_.begin(), spans_.begin() + next_);
+    return spans;
+}
+
+
+unsigned long long ExecutionTracer::dropped() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return dropped_;
+}
+
+
+void ExecutionTracer::clear()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    spans_.clear();
+    next_ = 0;
+    dropped_ = 0;
+}
+
+
+QByteArray ExecutionTracer::toJson() const
+{
+    std::vector<Span> spans = this->spans();
+    QByteArray pid = QByteArray::number(QCoreApplication::applicationPid());
+
+    QByteArray json("{\"traceEvents\":[");
+    for (std::size_t i = 0; i < spans.size(); ++i) {
+        const Span& span = spans[i];
+        if (i != 0) json += ',';
+        json += "\n{\"name\":\"";
+        json += phaseName(span.phase);
+        json += "\",\"cat\":\"";
+        json += jsonEscaped(span.language);
+        json += "\",\"ph\":\"X\",\"ts\":";
+        json += microseconds(span.begin);
+        json += ",\"dur\":";
+        json += microseconds(span.end - span.begin);
+        json += ",\"pid\":";
+        json += pid;
+        json += ",\"tid\":";
+        json += QByteArray::number(span.thread);
+        json += ",\"args\":{\"script\":";
+        json += QByteArray::number(span.scriptId);
+        json += ",\"interpreter\":\"0x";
+        json += QByteArray::number(quintptr(span.interpreter), 16);
+        json += "\"}}";
+    }
+    json += "\n],\"displayTimeUnit\":\"ns\"}\n";
+    return json;
+}
+
+
+bool ExecutionTracer::dump(const QString& path) const
+{
+    QFile f(path);
+    if (!f.open(QFile::WriteOnly | QFile::Truncate)) {
+        return false;
+    }
+    QByteArray json = this->toJson();
+    bool ok = f.write(json) == json.size();
+    f.close();
+    return ok;
+}
+
+
+const char* ExecutionTracer::phaseName(Phase phase)
+{
+    switch (phase) {
+    case ENQUEUE: return "enqueue";
+    case LOAD:    return "load";
+    case COMPILE: return "compile";
+    case RUN:     return "run";
+    case LOG:     return "log";
+    }
+    return "unknown";
+}
+
+} // namespace ScriptEmbedderNS
@@ -0,0 +1,83 @@
+/**
+ * @file
+ * @brief Implements the FileStamp class defined in filestamp.hh.
+ * @author Perttu Paarlahti 2016.
+ */
+
+#include "filestamp.hh"
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+
+#ifdef Q_OS_UNIX
+#include <sys/stat.h>
+#endif
+
+namespace ScriptEmbedderNS
+{
+
+FileStamp::FileStamp() :
+    valid_(false), mtime_(0), size_(0), inode_(0), device_(0)
+{
+}
+
+
+FileStamp FileStamp::read(const QString& path)
+{
+    FileStamp stamp;
+#ifdef Q_OS_UNIX
+    // Qt resources are not files.
+    if (!path.startsWith(':')) {
+        struct stat status;
+        if (::stat(QFile::encodeName(path).constData(), &status) != 0) {
+            return stamp;
+        }
+        stamp.valid_ = true;
+#if defined(Q_OS_DARWIN)
+        stamp.mtime_ = qint64(status.st_mtimespec.tv_sec) * 1000000000 +
+                status.st_mtimespec.tv_nsec;
+#elif defined(Q_OS_LINUX)
+        stamp.mtime_ = qint64(status.st_mtim.tv_sec) * 1000000000 + status.st_mtim.tv_nsec;
+#else
+        stamp.mtime_ = qint64(status.st_mtime) * 1000000000;
+#endif
+        stamp.size_ = qint64(status.st_size);
+        stamp.inode_ = quint64(status.st_ino);
+        stamp.device_ = quint64(status.st_dev);
+        return stamp;
+    }
+#endif
+
+    QFileInfo info(path);
+    if (!info.exists()) {
+        return stamp;
+    }
+    stamp.valid_ = true;
+    stamp.mtime_ = info.lastModified().toMSecsSinceEpoch() * 1000000;
+    stamp.size_ = info.size();
+    return stamp;
+}
+
+
+bool FileStamp::isValid() const
+{
+    return valid_;
+}
+
+
+bool FileStamp::operator==(const FileStamp& rhs) const
+{
+    return valid_ && rhs.valid_ &&
+            mtime_ == rhs.mtime_ &&
+            size_ == rhs.size_ &&
+            inode_ == rhs.inode_ &&
+            device_ == rhs.device_;
+}
+
+
+bool FileStamp::operator!=(const FileStamp& rhs) const
+{
+    return !(*this == rhs);
+}
+
+} // namespace ScriptEmbedderNS
@@ -0,0 +1,71 @@
+/**
+ * @file
+ * @brief Defines the FileStamp class, that identifies a version of a file
+ * by its status.
+ * @author Perttu Paarlahti 2016.
+ */
+
+#ifndef FILESTAMP_HH
+#define FILESTAMP_HH
+
+#include <QString>
+
+namespace ScriptEmbedderNS
+{
+
+/**
+ * @brief Status of a file used to detect changes without reading it.
+ * File is considered changed if its modification time, size, inode or
+ * device differs. Inode and device detect files replaced by renaming,
+ * which is how most editors save files. Reading the status is a single
+ * stat() call.
+ */
+class FileStamp
+{
+public:
+
+    /**
+     * @brief Constructor. Creates invalid stamp.
+     */
+    FileStamp();
+
+    /**
+     * @brief Read status of a file.
+     * @param path Path to the file. Qt resource paths are supported.
+     * @return File's stamp, or invalid stamp if file does not exist.
+     */
+    static FileStamp read(const QString& path);
+
+    /**
+     * @brief Check if stamp belongs to an existing file.
+     * @return True, if file existed when stamp was read.
+     */
+    bool isValid() const;
+
+    /**
+     * @brief Comparison for equality.
+     * @param rhs Compared stamp.
+     * @return True, if both stamps are valid and have identical status.
+     */
+    bool operator==(const FileStamp& rhs) const;
+
+    /**
+     * @brief Comparison for inequality.
+     * @param rhs Compared stamp.
+     * @return Negation of operator==.
+     */
+    bool operator!=(const FileStamp& rhs) const;
+
+
+private:
+
+    bool valid_;
+    qint64 mtime_;   // Modification time in nanoseconds since epoch.
+    qint64 size_;
+    quint64 inode_;
+    quint64 device_;
+};
+
+} // namespace ScriptEmbedderNS
+
+#endif // FILESTAMP_HH
@@ -0,0 +1,232 @@
+/**
+ * @file
+ * @brief Implements the FlightRecorder class defined in flightrecorder.hh.
+ * @author Perttu Paarlahti 2016.
+ */
+
+#include "flightrecorder.hh"
+#include <cerrno>
+#ifdef Q_OS_WIN
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace ScriptEmbedderNS
+{
+
+namespace
+{
+// Longest formatted record, see FlightRecorder::format.
+const std::size_t LINE_SIZE = 256;
+
+const char* ERROR_NAMES[] = {
+    "NONE", "NO_SUCH_SCRIPT", "SOURCE_NOT_AVAILABLE",
+    "ENTRY_POINTS_NOT_SUPPORTED", "SCRIPT_ERROR"
+};
+
+// Formatting helpers below are async-signal-safe.
+class LineWriter
+{
+public:
+    LineWriter(char* buffer, std::size_t size) :
+        buffer_(buffer), size_(size), length_(0) {}
+
+    void text(const char* str)
+    {
+        while (*str != '\0' && length_ < size_) {
+            buffer_[length_++] = *str++;
+        }
+    }
+
+    void number(quint64 value, unsigned base = 10)
+    {
+        char digits[32];
+        int count = 0;
+        do {
+            digits[count++] = "0123456789abcdef"[value % base];
+            value /= base;
+        } while (value != 0);
+        while (count > 0 && length_ < size_) {
+            buffer_[length_++] = digits[--count];
+        }
+    }
+
+    void signedNumber(qint64 value)
+    {
+        if (value < 0) {
+            this->text("-");
+            this->number(quint64(-(value + 1)) + 1);
+        } else {
+            this->number(quint64(value));
+        }
+    }
+
+    std::size_t length() const
+    {
+        return length_;
+    }
+
+private:
+    char* buffer_;
+    std::size_t size_;
+    std::size_t length_;
+};
+
+bool writeAll(int fd, const char* data, std::size_t size)
+{
+    while (size > 0) {
+#ifdef Q_OS_WIN
+        int written = ::_write(fd, data, unsigned(size));
+#else
+        ssize_t written = ::write(fd, data, size);
+#endif
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        data += written;
+        size -= std::size_t(written);
+    }
+    return true;
+}
+}
+
+
+FlightRecorder::FlightRecorder(unsigned capacity) :
+    clock_(), capacity_(capacity), slots_(new Slot[capacity]), written_(0)
+{
+    Q_ASSERT(capacity > 0);
+    for (unsigned i = 0; i < capacity; ++i) {
+        slots_[i].sequence.store(0, std::memory_order_relaxed);
+    }
+    clock_.start();
+}
+
+
+FlightRecorder::~FlightRecorder()
+{
+}
+
+
+void FlightRecorder::record(unsigned scriptId,
+                            uint paramsHash,
+                            qint64 duration,
+                            ScriptInterpreter::Result status,
+                            ScriptResultRecord::ErrorCode errorCode,
+                            const ScriptInterpreter* interpreter)
+{
+    quint64 sequence = written_.load(std::memory_order_relaxed) + 1;
+    Slot& slot = slots_[(sequence - 1) % capacity_];
+
+    // Mark slot as being written before touching the entry.
+    slot.sequence.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    slot.entry.sequence = sequence;
+    slot.entry.scriptId = scriptId;
+    slot.entry.paramsHash = paramsHash;
+    slot.entry.start = clock_.nsecsElapsed() - duration;
+    slot.entry.duration = duration;
+    slot.entry.status = status;
+    slot.entry.errorCode = errorCode;
+    slot.entry.interpreter = quintptr(interpreter);
+
+    slot.sequence.store(sequence, std::memory_order_release);
+    written_.store(sequence, std::memory_order_release);
+}
+
+
+unsigned FlightRecorder::capacity() const
+{
+    return capacity_;
+}
+
+
+std::vector<FlightRecorder::Entry> FlightRecorder::entries() const
+{
+    std::vector<Entry> entries;
+    quint64 written = written_.load(std::memory_order_acquire);
+    quint64 first = written > capacity_ ? written - capacity_ + 1 : 1;
+    entries.reserve(std::size_t(written - first + 1));
+
+    Entry entry;
+    for (quint64 sequence = first; sequence <= written; ++sequence) {
+        if (this->read(sequence, entry)) {
+            entries.push_back(entry);
+        }
+    }
+    return entries;
+}
+
+
+QString FlightRecorder::dump() const
+{
+    std::vector<Entry> entries = this->entries();
+    QString text;
+    char line[LINE_SIZE];
+    for (auto it = entries.begin(); it != entries.end(); ++it) {
+        std::size_t length = format(*it, line, LINE_SIZE);
+        text += QString::fromLatin1(line, int(length));
+    }
+    return text;
+}
+
+
+bool FlightRecorder::dump(int fd) const
+{
+    quint64 written = written_.load(std::memory_order_acquire);
+    quint64 first = written > capacity_ ? written - capacity_ + 1 : 1;
+
+    Entry entry;
+    char line[LINE_SIZE];
+    for (quint64 sequence = first; sequence <= written; ++sequence) {
+        if (!this->read(sequence, entry)) continue;
+
+        std::size_t length = format(entry, line, LINE_SIZE);
+        if (!writeAll(fd, line, length)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+bool FlightRecorder::read(quint64 sequence, Entry& entry) const
+{
+    const Slot& slot = slots_[(sequence - 1) % capacity_];
+    if (slot.sequence.load(std::memory_order_acquire) != sequence) {
+        return false;
+    }
+    entry = slot.entry;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return slot.sequence.load(std::memory_order_relaxed) == sequence;
+}
+
+
+std::size_t FlightRecorder::format(const Entry& entry, char* buffer, std::size_t size)
+{
+    LineWriter line(buffer, size - 1);
+    line.text("#");
+    line.number(entry.sequence);
+    line.text(" script=");
+    line.number(entry.scriptId);
+    line.text(" params=");
+    line.number(entry.paramsHash, 16);
+    line.text(" start=");
+    line.signedNumber(entry.start);
+    line.text("ns duration=");
+    line.signedNumber(entry.duration);
+    line.text("ns result=");
+    line.text(entry.status == ScriptInterpreter::SUCCESS ? "SUCCESS" : "FAILURE");
+    line.text(" error=");
+    line.text(ERROR_NAMES[entry.errorCode]);
+    line.text(" interpreter=0x");
+    line.number(entry.interpreter, 16);
+
+    std::size_t length = line.length();
+    buffer[length++] = '\n';
+    return length;
+}
+
+} // namespace ScriptEmbedderNS
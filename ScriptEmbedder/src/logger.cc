@@ -0,0 +1,63 @@
+/**
+ * @file
+ * @brief Implements the LogMessage class defined in logger.hh.
+ * @author Perttu Paarlahti 2016.
+ */
+
+#include "logger.hh"
+
+namespace ScriptEmbedderNS
+{
+
+LogMessage::LogMessage() :
+    format_(nullptr), text_(), strArgs_(), numArgs_(), isNumber_(), argCount_(0)
+{
+}
+
+
+LogMessage::LogMessage(const char* format) :
+    format_(format), text_(), strArgs_(), numArgs_(), isNumber_(), argCount_(0)
+{
+}
+
+
+LogMessage::LogMessage(const QString& message) :
+    format_(nullptr), text_(message), strArgs_(), numArgs_(), isNumber_(), argCount_(0)
+{
+}
+
+
+LogMessage& LogMessage::arg(const QString& a)
+{
+    Q_ASSERT(argCount_ < MAX_ARGS);
+    strArgs_[argCount_] = a;
+    isNumber_[argCount_] = false;
+    ++argCount_;
+    return *this;
+}
+
+
+LogMessage& LogMessage::arg(unsigned a)
+{
+    Q_ASSERT(argCount_ < MAX_ARGS);
+    numArgs_[argCount_] = a;
+    isNumber_[argCount_] = true;
+    ++argCount_;
+    return *this;
+}
+
+
+QString LogMessage::toString() const
+{
+    QString msg = format_ != nullptr ? QString::fromUtf8(format_) : text_;
+    for (int i = 0; i < argCount_; ++i) {
+        if (isNumber_[i]) {
+            msg = msg.arg(numArgs_[i]);
+        } else {
+            msg = msg.arg(strArgs_[i]);
+        }
+    }
+    return msg;
+}
+
+} // namespace ScriptEmbedderNS
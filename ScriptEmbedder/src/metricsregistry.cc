@@ -0,0 +1,235 @@
+/**
+ * @file
+ * @brief Implements the MetricsRegistry and LatencyHistogram classes defined
+ * in metricsregistry.hh.
+ * @author Perttu Paarlahti 2016.
+ */
+
+#include "metricsregistry.hh"
+#include <QtAlgorithms>
+#include <cmath>
+
+namespace ScriptEmbedderNS
+{
+
+LatencyHistogram::LatencyHistogram() :
+    total_(0), max_(0)
+{
+    for (int i = 0; i < BUCKETS; ++i) {
+        counts_[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+
+void LatencyHistogram::record(qint64 value)
+{
+    Q_ASSERT(value >= 0);
+    counts_[bucketOf(value)].fetch_add(1, std::memory_order_relaxed);
+    total_.fetch_add(value, std::memory_order_relaxed);
+
+    qint64 max = max_.load(std::memory_order_relaxed);
+    while (value > max &&
+           !max_.compare_exchange_weak(max, value, std::memory_order_relaxed)) {
+    }
+}
+
+
+TimeStatistics LatencyHistogram::statistics() const
+{
+    // Use a copy of the buckets, so that percentiles are consistent with count.
+    quint32 counts[BUCKETS];
+    quint64 count = 0;
+    for (int i = 0; i < BUCKETS; ++i) {
+        counts[i] = counts_[i].load(std::memory_order_relaxed);
+        count += counts[i];
+    }
+
+    TimeStatistics stats;
+    stats.count = count;
+    stats.total = total_.load(std::memory_order_relaxed);
+    stats.max = max_.load(std::memory_order_relaxed);
+    stats.p50 = this->percentile(counts, count, 0.5);
+    stats.p99 = this->percentile(counts, count, 0.99);
+    stats.p999 = this->percentile(counts, count, 0.999);
+    return stats;
+}
+
+
+int LatencyHistogram::bucketOf(quint64 value)
+{
+    if (value < quint64(SUB_COUNT)) {
+        return int(value);
+    }
+
+    int exponent = 63 - int(qCountLeadingZeroBits(value));
+    if (exponent >= MAX_EXPONENT) {
+        return BUCKETS - 1;
+    }
+    int shift = exponent - SUB_BITS;
+    int sub = int(value >> shift) - SUB_COUNT;
+    return SUB_COUNT + shift * SUB_COUNT + sub;
+}
+
+
+qint64 LatencyHistogram::upperBoundOf(int bucket)
+{
+    if (bucket < SUB_COUNT) {
+        return bucket;
+    }
+
+    int shift = (bucket - SUB_COUNT) / SUB_COUNT;
+    int sub = (bucket - SUB_COUNT) % SUB_COUNT;
+    qint64 lower = qint64(SUB_COUNT + sub) << shift;
+    return lower + (qint64(1) << shift) - 1;
+}
+
+
+qint64 LatencyHistogram::percentile(const quint32* counts, quint64 count, double p) const
+{
+    if (count == 0) return 0;
+
+    quint64 target = quint64(std::ceil(p * double(count)));
+    if (target == 0) target = 1;
+
+    quint64 cumulative = 0;
+    for (int i = 0; i < BUCKETS; ++i) {
+        cumulative += counts[i];
+        if (cumulative >= target) {
+            return qMin(upperBoundOf(i), max_.load(std::memory_order_relaxed));
+        }
+    }
+    return max_.load(std::memory_order_relaxed);
+}
+
+
+MetricsRegistry::MetricsRegistry() :
+    mutex_(), scripts_(), languages_()
+{
+}
+
+
+void MetricsRegistry::record(unsigned scriptId, const QString& language, const Sample& sample)
+{
+    // Only the recording thread modifies the maps, so it may search them
+    // without locking. Insertions are locked against snapshot().
+    ScriptCounters* script = nullptr;
+    auto it = scripts_.find(scriptId);
+    if (it == scripts_.end()) {
+        std::unique_ptr<ScriptCounters> counters(new ScriptCounters());
+        counters->language = language;
+        counters->languageCounters = this->languageCounters(language);
+        script = counters.get();
+        std::lock_guard<std::mutex> lock(mutex_);
+        scripts_[scriptId] = std::move(counters);
+    }
+    else {
+        script = it->second.get();
+        if (script->language != language) {
+            // Script has been replaced with one having a different language.
+            script->language = language;
+            script->languageCounters = this->languageCounters(language);
+        }
+    }
+
+    script->counters.record(sample);
+    script->languageCounters->record(sample);
+}
+
+
+void MetricsRegistry::remove(unsigned scriptId)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    scripts_.erase(scriptId);
+}
+
+
+MetricsSnapshot MetricsRegistry::snapshot() const
+{
+    MetricsSnapshot snapshot;
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto it = scripts_.begin(); it != scripts_.end(); ++it) {
+        snapshot.scripts[it->first] = it->second->counters.metrics();
+    }
+    for (auto it = languages_.begin(); it != languages_.end(); ++it) {
+        snapshot.languages[it->first] = it->second->metrics();
+    }
+    return snapshot;
+}
+
+
+MetricsRegistry::Counters* MetricsRegistry::languageCounters(const QString& language)
+{
+    auto it = languages_.find(language);
+    if (it != languages_.end()) {
+        return it->second.get();
+    }
+
+    Counters* counters = new Counters();
+    std::lock_guard<std::mutex> lock(mutex_);
+    languages_[language] = std::unique_ptr<Counters>(counters);
+    return counters;
+}
+
+
+MetricsRegistry::Counters::Counters() :
+    runs(0), failures(0), latency(), queueWait(nullptr), sourceLoad(nullptr)
+{
+}
+
+
+MetricsRegistry::Counters::~Counters()
+{
+    delete queueWait.load();
+    delete sourceLoad.load();
+}
+
+
+void MetricsRegistry::Counters::record(const Sample& sample)
+{
+    runs.fetch_add(1, std::memory_order_relaxed);
+    if (sample.failed) {
+        failures.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (sample.duration >= 0) {
+        latency.record(sample.duration);
+    }
+
+    // Optional histograms are allocated by the recording thread only.
+    if (sample.queueWait >= 0) {
+        LatencyHistogram* histogram = queueWait.load(std::memory_order_acquire);
+        if (histogram == nullptr) {
+            histogram = new LatencyHistogram();
+            queueWait.store(histogram, std::memory_order_release);
+        }
+        histogram->record(sample.queueWait);
+    }
+    if (sample.sourceLoad >= 0) {
+        LatencyHistogram* histogram = sourceLoad.load(std::memory_order_acquire);
+        if (histogram == nullptr) {
+            histogram = new LatencyHistogram();
+            sourceLoad.store(histogram, std::memory_order_release);
+        }
+        histogram->record(sample.sourceLoad);
+    }
+}
+
+
+ExecutionMetrics MetricsRegistry::Counters::metrics() const
+{
+    ExecutionMetrics metrics;
+    metrics.runs = runs.load(std::memory_order_relaxed);
+    metrics.failures = failures.load(std::memory_order_relaxed);
+    metrics.latency = latency.statistics();
+
+    LatencyHistogram* histogram = queueWait.load(std::memory_order_acquire);
+    if (histogram != nullptr) {
+        metrics.queueWait = histogram->statistics();
+    }
+    histogram = sourceLoad.load(std::memory_order_acquire);
+    if (histogram != nullptr) {
+        metrics.sourceLoad = histogram->statistics();
+    }
+    return metrics;
+}
+
+} // namespace ScriptEmbedderNS
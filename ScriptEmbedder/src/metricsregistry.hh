@@ -0,0 +1,148 @@
+/**
+ * @file
+ * @brief Defines the MetricsRegistry class that collects execution metrics,
+ * and the LatencyHistogram class used by it.
+ * @author Perttu Paarlahti 2016.
+ */
+
+#ifndef METRICSREGISTRY_HH
+#define METRICSREGISTRY_HH
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include "executionmetrics.hh"
+
+namespace ScriptEmbedderNS
+{
+
+/**
+ * @brief Histogram of durations with logarithmic buckets. Each power of two
+ * is divided into 8 linear sub-buckets, which limits the relative error of
+ * percentiles to 12.5%. Recording is wait-free. Values exceeding 2^36 ns
+ * (about 69 s) are counted into the last bucket.
+ */
+class LatencyHistogram
+{
+public:
+
+    /**
+     * @brief Constructor. Creates empty histogram.
+     */
+    LatencyHistogram();
+
+    /**
+     * @brief Record one measured duration.
+     * @param value Duration in nanoseconds.
+     * @pre value >= 0.
+     */
+    void record(qint64 value);
+
+    /**
+     * @brief Calculate statistics of recorded durations.
+     * @return Statistics. Values recorded concurrently may or may not be included.
+     */
+    TimeStatistics statistics() const;
+
+
+private:
+
+    static const int SUB_BITS = 3;
+    static const int SUB_COUNT = 1 << SUB_BITS;
+    static const int MAX_EXPONENT = 36;
+    static const int BUCKETS = (MAX_EXPONENT - SUB_BITS + 1) * SUB_COUNT;
+
+    std::atomic<quint32> counts_[BUCKETS];
+    std::atomic<qint64> total_;
+    std::atomic<qint64> max_;
+
+    static int bucketOf(quint64 value);
+    static qint64 upperBoundOf(int bucket);
+    qint64 percentile(const quint32* counts, quint64 count, double p) const;
+};
+
+
+/**
+ * @brief Collects execution metrics per script and per language.
+ * Only one thread may record metrics, but snapshot() may be called from any
+ * thread. Recording takes a lock only when a script or language is recorded
+ * for the first time.
+ */
+class MetricsRegistry
+{
+public:
+
+    /**
+     * @brief Measurements of one execution. Durations are in nanoseconds.
+     * Negative durations mean that the phase was not measured.
+     */
+    struct Sample
+    {
+        bool failed;
+        qint64 duration;
+        qint64 queueWait;
+        qint64 sourceLoad;
+    };
+
+    /**
+     * @brief Constructor. Creates empty registry.
+     */
+    MetricsRegistry();
+
+    /**
+     * @brief Record one execution.
+     * @param scriptId Id of the executed script.
+     * @param language Script's language.
+     * @param sample Measurements.
+     */
+    void record(unsigned scriptId, const QString& language, const Sample& sample);
+
+    /**
+     * @brief Drop metrics of a script. Language metrics are not affected.
+     * @param scriptId Id of the script.
+     * @pre Called from the recording thread.
+     */
+    void remove(unsigned scriptId);
+
+    /**
+     * @brief Get current metrics.
+     * @return Snapshot of metrics recorded so far.
+     */
+    MetricsSnapshot snapshot() const;
+
+
+private:
+
+    // Counters for one script or language. Histograms for optional
+    // measurements are allocated when first needed.
+    struct Counters
+    {
+        std::atomic<quint64> runs;
+        std::atomic<quint64> failures;
+        LatencyHistogram latency;
+        std::atomic<LatencyHistogram*> queueWait;
+        std::atomic<LatencyHistogram*> sourceLoad;
+
+        Counters();
+        ~Counters();
+        void record(const Sample& sample);
+        ExecutionMetrics metrics() const;
+    };
+
+    struct ScriptCounters
+    {
+        QString language;
+        Counters* languageCounters;
+        Counters counters;
+    };
+
+    mutable std::mutex mutex_;
+    std::map<unsigned, std::unique_ptr<ScriptCounters> > scripts_;
+    std::map<QString, std::unique_ptr<Counters> > languages_;
+
+    Counters* languageCounters(const QString& language);
+};
+
+} // namespace ScriptEmbedderNS
+
+#endif // METRICSREGISTRY_HH
@@ -0,0 +1,168 @@
+/**
+ * @file
+ * @brief Implements the RecordingScriptEmbedder class defined in
+ * recordingscriptembedder.hh.
+ * @author Perttu Paarlahti 2016.
+ */
+
+#include "recordingscriptembedder.hh"
+
+namespace ScriptEmbedderNS
+{
+
+RecordingScriptEmbedder::RecordingScriptEmbedder(ScriptEmbedder* embedder,
+                                                 const QString& tracePath) :
+    ScriptEmbedder(),
+    embedder_(embedder), writer_(), clock_(), logger_(nullptr)
+{
+    Q_ASSERT(embedder != nullptr);
+    writer_.open(tracePath);
+    clock_.start();
+}
+
+
+RecordingScriptEmbedder::~RecordingScriptEmbedder()
+{
+    writer_.close();
+}
+
+
+bool RecordingScriptEmbedder::reset(const Configuration& conf)
+{
+    return embedder_->reset(conf);
+}
+
+
+Configuration RecordingScriptEmbedder::configuration() const
+{
+    return embedder_->configuration();
+}
+
+
+bool RecordingScriptEmbedder::isValid() const
+{
+    return writer_.isOpen() && embedder_->isValid();
+}
+
+
+QString RecordingScriptEmbedder::errorString() const
+{
+    if (!writer_.errorString().isEmpty()) {
+        return writer_.errorString();
+    }
+    return embedder_->errorString();
+}
+
+
+void RecordingScriptEmbedder::execute(unsigned scriptId, const QStringList& params)
+{
+    if (writer_.isOpen()) {
+        TraceEvent event;
+        event.timestamp = clock_.nsecsElapsed();
+        event.scriptId = scriptId;
+        event.params = params;
+        if (!writer_.write(event)) {
+            // Trace is not continued after a lost block.
+            writer_.close();
+            if (logger_ != nullptr) {
+                logger_->logMessage(writer_.errorString());
+            }
+        }
+    }
+    embedder_->execute(scriptId, params);
+}
+
+
+void RecordingScriptEmbedder::prefetch(const std::vector<unsigned>& scriptIds)
+{
+    embedder_->prefetch(scriptIds);
+}
+
+
+void RecordingScriptEmbedder::setPromotionLimit(qint64 memoryLimit)
+{
+    embedder_->setPromotionLimit(memoryLimit);
+}
+
+
+void RecordingScriptEmbedder::setPredictivePrefetch(bool enabled)
+{
+    embedder_->setPredictivePrefetch(enabled);
+}
+
+
+bool RecordingScriptEmbedder::addScript(const ScriptEntry& script)
+{
+    return embedder_->addScript(script);
+}
+
+
+void RecordingScriptEmbedder::removeScript(unsigned scriptId)
+{
+    embedder_->removeScript(scriptId);
+}
+
+
+bool RecordingScriptEmbedder::addScripts(const std::vector<ScriptEntry>& scripts)
+{
+    return embedder_->addScripts(scripts);
+}
+
+
+void RecordingScriptEmbedder::removeScripts(const std::vector<unsigned>& scriptIds)
+{
+    embedder_->removeScripts(scriptIds);
+}
+
+
+bool RecordingScriptEmbedder::addInterpreter(const InterpreterEntry& interpreter)
+{
+    return embedder_->addInterpreter(interpreter);
+}
+
+
+void RecordingScriptEmbedder::setLogger(Logger* logger)
+{
+    logger_ = logger;
+    embedder_->setLogger(logger);
+}
+
+
+void RecordingScriptEmbedder::setBatchLogger(BatchLogger* logger,
+                                             unsigned maxBatchSize,
+                                             unsigned maxDelay)
+{
+    embedder_->setBatchLogger(logger, maxBatchSize, maxDelay);
+}
+
+
+void RecordingScriptEmbedder::flushResults()
+{
+    embedder_->flushResults();
+}
+
+
+void RecordingScriptEmbedder::flushExpired()
+{
+    embedder_->flushExpired();
+}
+
+
+MetricsSnapshot RecordingScriptEmbedder::metrics() const
+{
+    return embedder_->metrics();
+}
+
+
+void RecordingScriptEmbedder::setTracer(ExecutionTracer* tracer)
+{
+    embedder_->setTracer(tracer);
+}
+
+
+const FlightRecorder& RecordingScriptEmbedder::flightRecorder() const
+{
+    return embedder_->flightRecorder();
+}
+
+} // namespace ScriptEmbedderNS
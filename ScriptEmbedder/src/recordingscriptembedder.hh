@@ -0,0 +1,79 @@
+/**
+ * @file
+ * @brief Defines the RecordingScriptEmbedder class, a ScriptEmbedder
+ * decorator that records execute() calls into an execution trace.
+ * @author Perttu Paarlahti 2016.
+ */
+
+#ifndef RECORDINGSCRIPTEMBEDDER_HH
+#define RECORDINGSCRIPTEMBEDDER_HH
+
+#include "scriptembedder.hh"
+#include "executiontrace.hh"
+#include <memory>
+#include <QElapsedTimer>
+
+namespace ScriptEmbedderNS
+{
+
+/**
+ * @brief Forwards all calls to another ScriptEmbedder, and records each
+ * execute() call with its parameters and time into a trace file. If writing
+ * the trace fails, recording stops: embedder becomes invalid, error message
+ * is available in errorString() and Logger is notified. Scripts are still
+ * executed.
+ */
+class RecordingScriptEmbedder : public ScriptEmbedder
+{
+public:
+
+    /**
+     * @brief Constructor. Creates the trace file.
+     * @param embedder Embedder executing the scripts. Ownership is passed
+     * to the new object.
+     * @param tracePath Path of the trace file.
+     * @pre embedder != nullptr.
+     * @post If trace file could not be created, embedder is invalid and
+     * error message is available in errorString().
+     */
+    RecordingScriptEmbedder(ScriptEmbedder* embedder, const QString& tracePath);
+
+    /**
+     * @brief Destructor. Closes the trace file.
+     */
+    virtual ~RecordingScriptEmbedder();
+
+    // ScriptEmbedder interface
+    bool reset(const Configuration& conf);
+    Configuration configuration() const;
+    bool isValid() const;
+    QString errorString() const;
+    void execute(unsigned scriptId, const QStringList& params);
+    void prefetch(const std::vector<unsigned>& scriptIds);
+    void setPromotionLimit(qint64 memoryLimit);
+    void setPredictivePrefetch(bool enabled);
+    bool addScript(const ScriptEntry& script);
+    void removeScript(unsigned scriptId);
+    bool addScripts(const std::vector<ScriptEntry>& scripts);
+    void removeScripts(const std::vector<unsigned>& scriptIds);
+    bool addInterpreter(const InterpreterEntry& interpreter);
+    void setLogger(Logger* logger);
+    void setBatchLogger(BatchLogger* logger, unsigned maxBatchSize, unsigned maxDelay);
+    void flushResults();
+    void flushExpired();
+    MetricsSnapshot metrics() const;
+    void setTracer(ExecutionTracer* tracer);
+    const FlightRecorder& flightRecorder() const;
+
+
+private:
+
+    std::unique_ptr<ScriptEmbedder> embedder_;
+    ExecutionTraceWriter writer_;
+    QElapsedTimer clock_;
+    Logger* logger_;
+};
+
+} // namespace ScriptEmbedderNS
+
+#endif // RECORDINGSCRIPTEMBEDDER_HH
@@ -6,14 +6,23 @@
 
 #include "scriptembedderbuilder.hh"
 #include "serialscriptembedder.hh"
+#include "recordingscriptembedder.hh"
 
 namespace ScriptEmbedderNS
 {
 
 ScriptEmbedder*ScriptEmbedderBuilder::createSerialEmbedder(const Configuration& conf)
 {
-    Q_ASSERT(conf.isValid());
+    // SerialScriptEmbedder checks the precondition.
     return new SerialScriptEmbedder(conf);
 }
 
+
+ScriptEmbedder* ScriptEmbedderBuilder::createRecordingEmbedder(ScriptEmbedder* embedder,
+                                                               const QString& tracePath)
+{
+    Q_ASSERT(embedder != nullptr);
+    return new RecordingScriptEmbedder(embedder, tracePath);
+}
+
 }// namespace ScriptEmbedderNS
@@ -0,0 +1,180 @@
+/**
+ * @file
+ * @brief Implements the ScriptSource class defined in scriptsource.hh.
+ * @author Perttu Paarlahti 2016.
+ */
+
+#include "scriptsource.hh"
+#include <QCryptographicHash>
+
+namespace ScriptEmbedderNS
+{
+
+namespace
+{
+// Hash of stored data. Kind of the storage is included, so that for example
+// a copied source is never shared with a mapped one.
+QByteArray hashOf(char kind, const char* data, int size)
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(&kind, 1);
+    hash.addData(data, size);
+    return hash.result();
+}
+}
+
+
+std::shared_ptr<ScriptSource> ScriptSource::create(const ScriptEntry& script, bool utf8)
+{
+    std::shared_ptr<ScriptSource> source = ScriptSource::load(script, utf8);
+    if (source == nullptr) {
+        return nullptr;
+    }
+
+    if (!source->compressed_.isNull()) {
+        const QByteArray& data = source->compressed_;
+        source->hash_ = hashOf('z', data.constData(), data.size());
+    }
+    else if (source->data_ != nullptr) {
+        source->hash_ = hashOf('m', reinterpret_cast<const char*>(source->data_),
+                               int(source->size_));
+    }
+    else if (!source->bytes_.isNull()) {
+        source->hash_ = hashOf('u', source->bytes_.constData(), source->bytes_.size());
+    }
+    else {
+        source->hash_ = hashOf('t', reinterpret_cast<const char*>(source->text_.constData()),
+                               source->text_.size() * int(sizeof(QChar)));
+    }
+    return source;
+}
+
+
+std::shared_ptr<ScriptSource> ScriptSource::load(const ScriptEntry& script, bool utf8)
+{
+    std::shared_ptr<ScriptSource> source(new ScriptSource());
+    ScriptEntry::Storage storage = script.storage;
+    if (script.isInline()) {
+        if (storage == ScriptEntry::COMPRESSED) {
+            source->compressed_ = qCompress(script.source.toUtf8());
+        }
+        else if (utf8) {
+            source->bytes_ = script.source.toUtf8();
+        }
+        else {
+            // Shares data with the script entry.
+            source->text_ = script.source;
+        }
+        return source;
+    }
+
+    QFile& f = source->file_;
+    f.setFileName(script.scriptPath);
+    if (!f.open(QFile::ReadOnly)) {
+        return nullptr;
+    }
+
+    // Qt resources are already in memory, and mapping them is not
+    // supported for all resources.
+    if (storage == ScriptEntry::MAPPED && script.scriptPath.startsWith(':')) {
+        storage = ScriptEntry::COPY;
+    }
+
+    if (storage == ScriptEntry::MAPPED) {
+        // Mapping remains valid while file object exists.
+        source->size_ = f.size();
+        source->data_ = source->size_ > 0 ? f.map(0, source->size_) : nullptr;
+        if (source->data_ == nullptr) {
+            return nullptr;
+        }
+        source->bytes_ = QByteArray::fromRawData(reinterpret_cast<const char*>(source->data_),
+                                                 int(source->size_));
+    }
+    else if (storage == ScriptEntry::COMPRESSED) {
+        QByteArray contents = f.readAll();
+        f.close();
+        if (contents.isEmpty()) {
+            return nullptr;
+        }
+        source->compressed_ = qCompress(contents);
+    }
+    else if (utf8) {
+        source->bytes_ = f.readAll();
+        f.close();
+        if (source->bytes_.isEmpty()) {
+            return nullptr;
+        }
+    }
+    else {
+        source->text_ = QString::fromUtf8(f.readAll());
+        f.close();
+        if (source->text_.isEmpty()) {
+            return nullptr;
+        }
+    }
+    return source;
+}
+
+
+ScriptSource::~ScriptSource()
+{
+    // Release the raw data view before unmapping.
+    bytes_.clear();
+    if (data_ != nullptr) {
+        file_.unmap(const_cast<uchar*>(data_));
+    }
+}
+
+
+QByteArray ScriptSource::utf8()
+{
+    if (!compressed_.isNull()) {
+        return qUncompress(compressed_);
+    }
+    if (bytes_.isNull()) {
+        bytes_ = text_.toUtf8();
+    }
+    return bytes_;
+}
+
+
+QString ScriptSource::text()
+{
+    if (!compressed_.isNull()) {
+        return QString::fromUtf8(qUncompress(compressed_));
+    }
+    if (text_.isNull()) {
+        text_ = QString::fromUtf8(bytes_);
+    }
+    return text_;
+}
+
+
+bool ScriptSource::isCompressed() const
+{
+    return !compressed_.isNull();
+}
+
+
+QByteArray ScriptSource::hash() const
+{
+    return hash_;
+}
+
+
+qint64 ScriptSource::memoryUsage() const
+{
+    qint64 usage = compressed_.size() + qint64(text_.size()) * qint64(sizeof(QChar));
+    if (data_ == nullptr) {
+        usage += bytes_.size();
+    }
+    return usage;
+}
+
+
+ScriptSource::ScriptSource() :
+    file_(), data_(nullptr), size_(0), bytes_(), text_(), compressed_(), hash_()
+{
+}
+
+} // namespace ScriptEmbedderNS
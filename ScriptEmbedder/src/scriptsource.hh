@@ -0,0 +1,104 @@
+/**
+ * @file
+ * @brief Defines the ScriptSource class that holds the source code of a
+ * script read to RAM.
+ * @author Perttu Paarlahti 2016.
+ */
+
+#ifndef SCRIPTSOURCE_HH
+#define SCRIPTSOURCE_HH
+
+#include <QByteArray>
+#include <QFile>
+#include <QString>
+#include <memory>
+#include "configuration.hh"
+
+namespace ScriptEmbedderNS
+{
+
+/**
+ * @brief Source code of a script read to RAM, stored as defined by
+ * ScriptEntry::storage. Copied sources are kept in the encoding preferred
+ * by the interpreter: either decoded into a string when loaded, or as UTF-8
+ * bytes. Mapped sources keep the file mapped. Sources not decoded when
+ * loaded are decoded on the first call to text(). Compressed sources keep
+ * only the compressed bytes, and are decompressed on each call to utf8()
+ * or text(); caching decompressed sources is left to the caller.
+ */
+class ScriptSource
+{
+public:
+
+    /**
+     * @brief Create source of a script from its inline source, or by loading
+     * its source file.
+     * @param script Script entry defining the source and its storage.
+     * @param utf8 If true, copied source is kept as UTF-8 bytes. Has no
+     * effect on mapped and compressed sources.
+     * @return New source, or nullptr if file does not open or is empty.
+     * @pre -
+     * @note This method may be called concurrently from several threads.
+     */
+    static std::shared_ptr<ScriptSource> create(const ScriptEntry& script, bool utf8);
+
+    /**
+     * @brief Destructor. Unmaps the file.
+     */
+    ~ScriptSource();
+
+    /**
+     * @brief Get source as UTF-8. Source kept as UTF-8 is returned without
+     * copying, other source is encoded on the first call only. Returned view
+     * to a mapped source is valid only as long as this object exists.
+     * @return UTF-8 encoded source.
+     */
+    QByteArray utf8();
+
+    /**
+     * @brief Get source as a string. Source that is not kept as a string is
+     * decoded on the first call only.
+     * @return Source code.
+     */
+    QString text();
+
+    /**
+     * @brief Check if source is compressed.
+     * @return True, if storage is ScriptEntry::COMPRESSED.
+     */
+    bool isCompressed() const;
+
+    /**
+     * @brief Get number of bytes held in RAM by this source. Mapped pages
+     * are not counted, as they can be reclaimed by the system.
+     * @return Size of the stored source.
+     */
+    qint64 memoryUsage() const;
+
+    /**
+     * @brief Get hash identifying the stored source. Sources having equal
+     * contents and storage have equal hashes, and can be shared by scripts.
+     * @return Hash of the source computed when it was created.
+     */
+    QByteArray hash() const;
+
+
+private:
+
+    ScriptSource();
+    ScriptSource(const ScriptSource&) = delete;
+    static std::shared_ptr<ScriptSource> load(const ScriptEntry& script, bool utf8);
+    ScriptSource& operator=(const ScriptSource&) = delete;
+
+    QFile file_;
+    const uchar* data_;
+    qint64 size_;
+    QByteArray bytes_;
+    QString text_;
+    QByteArray compressed_;
+    QByteArray hash_;
+};
+
+} // namespace ScriptEmbedderNS
+
+#endif // SCRIPTSOURCE_HH
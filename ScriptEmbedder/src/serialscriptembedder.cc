@@ -5,25 +5,100 @@
  */
 
 #include "serialscriptembedder.hh"
+#include <algorithm>
+#include <cmath>
+#include <limits>
 #include <set>
+#include <thread>
+#include <QCryptographicHash>
 #include <QFileInfo>
+#include <QElapsedTimer>
 #include <QPluginLoader>
 
 namespace ScriptEmbedderNS
 {
 
+namespace
+{
+// Minimum number of scripts validated by one thread in addScripts.
+const std::size_t SCRIPTS_PER_THREAD = 64;
+
+// Maximum total size of decompressed sources kept in RAM.
+const qint64 SOURCE_CACHE_SIZE = 1024 * 1024;
+
+// Threads reading prefetched sources, maximum number of prefetched
+// sources, and their maximum age in milliseconds. Few threads suffice, as
+// they only wait for storage.
+const unsigned PREFETCH_THREADS = 2;
+const unsigned MAX_PREFETCHED = 64;
+const qint64 MAX_PREFETCH_AGE = 2000;
+
+// Script executed within SUCCESSOR_WINDOW milliseconds after another one
+// is counted as its successor in predictive prefetching.
+const qint64 SUCCESSOR_WINDOW = 1000;
+
+// Execution counts of on-demand scripts halve in PROMOTION_HALF_LIFE
+// milliseconds. Script is promoted to RAM when its count reaches
+// PROMOTION_HEAT, and demoted when it falls below DEMOTION_HEAT.
+// Demotions are checked once per half-life.
+const double PROMOTION_HALF_LIFE = 60000.0;
+const double PROMOTION_HEAT = 8.0;
+const double DEMOTION_HEAT = 1.0;
+
+/**
+ * @brief Hash identifying source of a prepared program.
+ * @param utf8 If true, source is in script, else in text.
+ * @param script UTF-8 source.
+ * @param text Source string.
+ * @return SHA-1 hash of the source.
+ */
+QByteArray programHash(bool utf8, const QByteArray& script, const QString& text)
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    if (utf8) {
+        hash.addData(script);
+    }
+    else {
+        hash.addData(reinterpret_cast<const char*>(text.constData()),
+                     text.size() * int(sizeof(QChar)));
+    }
+    return hash.result();
+}
+
+/**
+ * @brief Key of a decompressed source in SourceCache.
+ * @param hash Hash of the compressed source.
+ * @param utf8 True for UTF-8 bytes, false for string.
+ * @return Cache key.
+ */
+QByteArray cacheKey(const QByteArray& hash, bool utf8)
+{
+    return hash + (utf8 ? 'u' : 't');
+}
+}
+
+
 SerialScriptEmbedder::SerialScriptEmbedder(const Configuration& conf) :
     ScriptEmbedder(),
     conf_(), logger_(nullptr), valid_(true), errorStr_(),
-    loaders_(), interpreters_(), scripts_()
+    loaders_(), interpreters_(), scripts_(), prepared_(), programs_(),
+    programIndex_(), nextHandle_(0), pool_(),
+    batchLogger_(nullptr), maxBatchSize_(1), maxBatchDelay_(0),
+    batch_(), batchTimer_(), metrics_(), tracer_(nullptr),
+    flightRecorder_(), sourceCache_(SOURCE_CACHE_SIZE), stamps_(), clock_(),
+    prefetcher_(PREFETCH_THREADS, MAX_PREFETCHED, MAX_PREFETCH_AGE),
+    predictor_(SUCCESSOR_WINDOW), predictive_(false), heat_(), promoted_(),
+    promotionLimit_(0), promotedMemory_(0), lastSweep_(0)
 {
     Q_ASSERT(conf.isValid());
+    clock_.start();
     this->reset(conf);
 }
 
 
 SerialScriptEmbedder::~SerialScriptEmbedder()
 {
+    this->flushResults();
     this->clearConfiguration();
 }
 
@@ -42,11 +117,20 @@ bool SerialScriptEmbedder::reset(const Configuration& conf)
     }
 
     // Update scripts.
-    std::map<unsigned, ScriptEntry> entries = conf.scripts();
+    const std::map<unsigned, ScriptEntry>& entries = conf.scripts();
     for (auto it = entries.begin(); it != entries.end(); ++it) {
-        if (it->second.readToRAM) {
-            scripts_[it->first] = this->readScript(it->second.scriptPath);
-            if (scripts_[it->first].isEmpty()){
+        if (!this->supportsEntryPoint(it->second)) {
+            errorStr_ = QString("Configuration failed: interpreter for '%1' does "
+                                "not support entry points (script '%2').")
+                    .arg(it->second.scriptLanguage).arg(it->second.id);
+            logMsg(errorString());
+            this->clearConfiguration();
+            return false;
+        }
+        if (it->second.readToRAM || it->second.isInline()) {
+            std::shared_ptr<ScriptSource> source = ScriptSource::create(
+                        it->second, this->prefersUtf8(it->second.scriptLanguage));
+            if (source == nullptr){
                 errorStr_ = QString("Configuration failed: source file '%1' "
                                     "for script '%2' does not open or is empty.")
                         .arg(it->second.scriptPath).arg(it->second.id);
@@ -54,6 +138,7 @@ bool SerialScriptEmbedder::reset(const Configuration& conf)
                 this->clearConfiguration();
                 return false;
             }
+            scripts_[it->first] = pool_.intern(source);
         }
     }
 
@@ -84,45 +169,211 @@ QString SerialScriptEmbedder::errorString() const
 
 void SerialScriptEmbedder::execute(unsigned scriptId, const QStringList& params)
 {
+    ExecutionStats stats;
+    stats.timer.start();
+    stats.sourceLoad = -1;
+    stats.interpreter = nullptr;
+    stats.traceOrigin = tracer_ != nullptr ? tracer_->now() : 0;
+
     // Check that script exists.
     ScriptEntry scriptEntry = conf_.getScript(scriptId);
-    if (scriptEntry == ScriptEntry()) {
-        if (logger_ != nullptr){
-            scriptEntry.id = scriptId;
-            logger_->scriptFailed(scriptEntry, params,
-                                  QString("Script '%1' does not exist.").arg(scriptId));
-            return;
+    stats.timing.lookup = stats.timer.nsecsElapsed();
+    bool exists = !(scriptEntry == ScriptEntry());
+    scriptEntry.id = scriptId;
+    this->trace(ExecutionTracer::ENQUEUE, scriptEntry, stats, 0, stats.timing.lookup);
+    if (!exists) {
+        this->reportFailure(scriptEntry, params, ScriptResultRecord::NO_SUCH_SCRIPT,
+                            LogMessage("Script '%1' does not exist.").arg(scriptId),
+                            stats);
+        return;
+    }
+
+    // Likely next scripts are read while this one executes.
+    if (predictive_) {
+        predictor_.record(scriptId, clock_.elapsed());
+        std::vector<unsigned> next = predictor_.predict(scriptId);
+        if (!next.empty()) {
+            this->prefetch(next);
         }
     }
 
     ScriptInterpreter::ScriptRunResult result;
     std::shared_ptr<ScriptInterpreter> interpreter = interpreters_[scriptEntry.scriptLanguage];
-    QString scriptStr;
+    stats.interpreter = interpreter.get();
+    bool entryPointMode = !scriptEntry.entryPoint.isEmpty();
+
+    // Entry points are checked when scripts are added, but the interpreter
+    // may have been replaced since.
+    if (entryPointMode && !interpreter->supportsEntryPoints()) {
+        this->reportFailure(scriptEntry, params, ScriptResultRecord::ENTRY_POINTS_NOT_SUPPORTED,
+                            LogMessage("Interpreter for '%1' does not support entry points.")
+                            .arg(scriptEntry.scriptLanguage),
+                            stats);
+        return;
+    }
+
+    // Cached sources are loaded again if their file has changed.
+    if (scriptEntry.isCached()) {
+        this->refreshSource(scriptEntry, interpreter->prefersUtf8(), stats);
+    }
+    else if (promotionLimit_ > 0 && !scriptEntry.readToRAM && !scriptEntry.isInline()) {
+        this->updateHeat(scriptEntry, interpreter->prefersUtf8(), stats);
+    }
 
-    // Get script as a string.
-    if (scriptEntry.readToRAM){
-        scriptStr = scripts_[scriptEntry.id];
+    // Prepared scripts need not to be loaded or evaluated again.
+    auto prepared = entryPointMode ? prepared_.find(scriptEntry.id) : prepared_.end();
+    if (prepared != prepared_.end()) {
+        qint64 runStart = stats.timer.nsecsElapsed();
+        interpreter->enterExecutionScope();
+        result = interpreter->call(prepared->second, scriptEntry.entryPoint, params);
+        interpreter->leaveExecutionScope();
+        stats.timing.run = stats.timer.nsecsElapsed() - runStart;
+        this->trace(ExecutionTracer::RUN, scriptEntry, stats,
+                    runStart, runStart + stats.timing.run);
+        this->reportResult(scriptEntry, params, result, stats);
+        return;
+    }
+
+    // Get script in the encoding preferred by the interpreter.
+    bool utf8 = interpreter->prefersUtf8();
+    QString scriptStr;
+    QByteArray scriptUtf8;
+    auto resident = scripts_.find(scriptEntry.id);
+    if (resident != scripts_.end()){
+        // Keeps a mapped source mapped while it is being used.
+        std::shared_ptr<ScriptSource> source = resident->second;
+        if (!source->isCompressed()) {
+            if (utf8) {
+                scriptUtf8 = source->utf8();
+            }
+            else {
+                scriptStr = source->text();
+            }
+        }
+        else if (utf8 ? !sourceCache_.find(cacheKey(source->hash(), true), scriptUtf8) :
+                 !sourceCache_.find(cacheKey(source->hash(), false), scriptStr)) {
+            // Decompress and keep recently executed sources decompressed.
+            qint64 decodeStart = stats.timer.nsecsElapsed();
+            if (utf8) {
+                scriptUtf8 = source->utf8();
+                sourceCache_.insert(cacheKey(source->hash(), true), scriptUtf8);
+            }
+            else {
+                scriptStr = source->text();
+                sourceCache_.insert(cacheKey(source->hash(), false), scriptStr);
+            }
+            stats.timing.decode = stats.timer.nsecsElapsed() - decodeStart;
+        }
     }
     else {
-        scriptStr = this->readScript(scriptEntry.scriptPath);
-        if (scriptStr.isEmpty()) {
-            if (logger_ != nullptr) {
-                logger_->scriptFailed(scriptEntry, params,
-                                      QString("File '%1' does not open or is empty.")
-                                      .arg(scriptEntry.scriptPath));
-                return;
+        qint64 loadStart = stats.timer.nsecsElapsed();
+        if (!prefetcher_.take(scriptEntry.id, scriptUtf8)) {
+            scriptUtf8 = this->readFile(scriptEntry.scriptPath);
+        }
+        qint64 decodeStart = stats.timer.nsecsElapsed();
+        stats.timing.load = decodeStart - loadStart;
+        stats.sourceLoad = stats.timing.load;
+        if (!utf8) {
+            scriptStr = QString::fromUtf8(scriptUtf8);
+            scriptUtf8.clear();
+            stats.timing.decode = stats.timer.nsecsElapsed() - decodeStart;
+            stats.sourceLoad += stats.timing.decode;
+        }
+        this->trace(ExecutionTracer::LOAD, scriptEntry, stats,
+                    loadStart, loadStart + stats.sourceLoad);
+        if (utf8 ? scriptUtf8.isEmpty() : scriptStr.isEmpty()) {
+            this->reportFailure(scriptEntry, params, ScriptResultRecord::SOURCE_NOT_AVAILABLE,
+                                LogMessage("File '%1' does not open or is empty.")
+                                .arg(scriptEntry.scriptPath),
+                                stats);
+            return;
+        }
+    }
+
+    // Run script in its own scope and report results.
+    qint64 runStart = stats.timer.nsecsElapsed();
+    interpreter->enterExecutionScope();
+    qint64 callStart = runStart;
+    bool called = true;
+    if (entryPointMode) {
+        // Scripts having identical source share one prepared program.
+        auto key = std::make_pair(scriptEntry.scriptLanguage,
+                                  programHash(utf8, scriptUtf8, scriptStr));
+        auto shared = programIndex_.find(key);
+        unsigned handle = 0;
+        if (shared != programIndex_.end()) {
+            handle = shared->second;
+        }
+        else {
+            handle = nextHandle_++;
+            result = utf8 ? interpreter->prepareScriptUtf8(handle, scriptUtf8) :
+                            interpreter->prepareScript(handle, scriptStr);
+            callStart = stats.timer.nsecsElapsed();
+            this->trace(ExecutionTracer::COMPILE, scriptEntry, stats, runStart, callStart);
+            called = result.result == ScriptInterpreter::SUCCESS;
+            if (called) {
+                programs_[handle] = Program{key.first, key.second, 0};
+                programIndex_[key] = handle;
             }
         }
+        if (called) {
+            ++programs_[handle].users;
+            prepared_[scriptEntry.id] = handle;
+            result = interpreter->call(handle, scriptEntry.entryPoint, params);
+        }
+    }
+    else {
+        result = utf8 ? interpreter->runScriptUtf8(scriptUtf8, params) :
+                        interpreter->runScript(scriptStr, params);
     }
+    interpreter->leaveExecutionScope();
+    stats.timing.run = stats.timer.nsecsElapsed() - runStart;
+    if (called) {
+        this->trace(ExecutionTracer::RUN, scriptEntry, stats,
+                    callStart, runStart + stats.timing.run);
+    }
+    this->reportResult(scriptEntry, params, result, stats);
+}
 
-    // Run script and report results.
-    result = interpreter->runScript(scriptStr, params);
-    if (logger_ != nullptr) {
-        if (result.result == ScriptInterpreter::FAILURE){
-            logger_->scriptFailed(scriptEntry, params, result.errorString);
-        } else {
-            logger_->scriptExecuted(scriptEntry, params, result.returnValue);
+
+void SerialScriptEmbedder::prefetch(const std::vector<unsigned>& scriptIds)
+{
+    // Scripts beyond the limit would replace the first ones.
+    const std::map<unsigned, ScriptEntry>& scripts = conf_.scripts();
+    std::size_t count = std::min<std::size_t>(scriptIds.size(), MAX_PREFETCHED);
+    for (std::size_t i = 0; i < count; ++i) {
+        auto script = scripts.find(scriptIds[i]);
+        if (script == scripts.end() || script->second.readToRAM ||
+                script->second.isInline() || script->second.isCached() ||
+                prepared_.find(scriptIds[i]) != prepared_.end() ||
+                promoted_.find(scriptIds[i]) != promoted_.end()) {
+            continue;
         }
+        prefetcher_.request(scriptIds[i], script->second.scriptPath);
+    }
+}
+
+
+void SerialScriptEmbedder::setPromotionLimit(qint64 memoryLimit)
+{
+    Q_ASSERT(memoryLimit >= 0);
+    promotionLimit_ = memoryLimit;
+    if (memoryLimit == 0) {
+        heat_.clear();
+    }
+    for (auto it = heat_.begin(); it != heat_.end(); ++it) {
+        it->second.retry = 0;
+    }
+    // Demotes coldest scripts until promoted sources fit in the limit.
+    this->makeRoom(0, std::numeric_limits<double>::max(), clock_.elapsed());
+}
+
+
+void SerialScriptEmbedder::setPredictivePrefetch(bool enabled)
+{
+    predictive_ = enabled;
+    if (!enabled) {
+        predictor_.clear();
     }
 }
 
@@ -132,7 +383,7 @@ bool SerialScriptEmbedder::addScript(const ScriptEntry& script)
     ScriptEntry entry = conf_.getScript(script.id);
     if (entry == script){
         // Identical script already exists.
-        logMsg(QString("Script '%1' already exists.").arg(script.id));
+        logMsg(LogMessage("Script '%1' already exists.").arg(script.id));
         return true;
     }
     if (!conf_.hasInterpreter(script.scriptLanguage)){
@@ -143,7 +394,14 @@ bool SerialScriptEmbedder::addScript(const ScriptEntry& script)
         logMsg(errorString());
         return false;
     }
-    if (!QFileInfo::exists(script.scriptPath)){
+    if (!this->supportsEntryPoint(script)){
+        errorStr_ = QString("Could not add script '%1': Interpreter for '%2' "
+                            "does not support entry points.")
+                .arg(script.id).arg(script.scriptLanguage);
+        logMsg(errorString());
+        return false;
+    }
+    if (!script.isInline() && !QFileInfo::exists(script.scriptPath)){
         // Script file does not exist.
         errorStr_ = QString("Could not add script: file '%1' does not exist.")
                 .arg(script.scriptPath);
@@ -151,27 +409,31 @@ bool SerialScriptEmbedder::addScript(const ScriptEntry& script)
         return false;
     }
 
-    if (script.readToRAM){
+    if (script.readToRAM || script.isInline()){
         // Read script to RAM.
-        QString scriptStr = this->readScript(script.scriptPath);
-        if (scriptStr.isEmpty()) {
+        std::shared_ptr<ScriptSource> source = ScriptSource::create(
+                    script, this->prefersUtf8(script.scriptLanguage));
+        if (source == nullptr) {
             errorStr_ = QString("Could not add script %1: File '%2' "
                                 "does not open or is empty.")
                     .arg(script.id).arg(script.scriptPath);
             logMsg(errorString());
             return false;
         }
-        scripts_[script.id] = scriptStr;
+        // Interned before releasing the old source, which may be identical.
+        source = pool_.intern(source);
+        this->forgetScriptState(script.id, false);
+        scripts_[script.id] = source;
     }
-    else if (scripts_.find(script.id) != scripts_.end()){
-        scripts_.erase(script.id);
+    else {
+        this->forgetScriptState(script.id, false);
     }
 
     // Add to configuration and send log messages.
     if (conf_.hasScript(script.id)){
-        logMsg(QString("Script '%1' replaced.").arg(script.id));
+        logMsg(LogMessage("Script '%1' replaced.").arg(script.id));
     } else {
-        logMsg(QString("Script '%1' added.").arg(script.id));
+        logMsg(LogMessage("Script '%1' added.").arg(script.id));
     }
     conf_.addScript(script);
     return true;
@@ -181,14 +443,138 @@ bool SerialScriptEmbedder::addScript(const ScriptEntry& script)
 void SerialScriptEmbedder::removeScript(unsigned scriptId)
 {
     if (!conf_.hasScript(scriptId)){
-        this->logMsg(QString("Could not remove script '%1': No such script.")
+        this->logMsg(LogMessage("Could not remove script '%1': No such script.")
                      .arg(scriptId));
         return;
     }
 
+    this->forgetScriptState(scriptId, true);
     conf_.removeScript(scriptId);
-    scripts_.erase(scriptId);
-    this->logMsg(QString("Script '%1' removed.").arg(scriptId));
+    this->logMsg(LogMessage("Script '%1' removed.").arg(scriptId));
+}
+
+
+bool SerialScriptEmbedder::addScripts(const std::vector<ScriptEntry>& scripts)
+{
+    // Pick the last entry for each id, and skip identical existing scripts.
+    std::map<unsigned, std::size_t> lastIndex;
+    for (std::size_t i = 0; i < scripts.size(); ++i) {
+        lastIndex[scripts[i].id] = i;
+    }
+    std::vector<const ScriptEntry*> added;
+    added.reserve(lastIndex.size());
+    for (auto it = lastIndex.begin(); it != lastIndex.end(); ++it) {
+        const ScriptEntry& script = scripts[it->second];
+        if (!(conf_.getScript(script.id) == script)) {
+            added.push_back(&script);
+        }
+    }
+    std::size_t unchanged = lastIndex.size() - added.size();
+
+    // Validate. Files are checked and read by several threads, as each
+    // check is a separate system call.
+    std::vector<std::shared_ptr<ScriptSource>> sources(added.size());
+    std::vector<QString> errors(added.size());
+    std::vector<char> utf8(added.size(), 0);
+    auto validate = [&added, &utf8, &sources, &errors](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+            const ScriptEntry& script = *added[i];
+            if (!errors[i].isEmpty()) {
+                continue;
+            }
+            if (!script.isInline() && !QFileInfo::exists(script.scriptPath)) {
+                errors[i] = QString("Could not add script: file '%1' does not exist.")
+                        .arg(script.scriptPath);
+            }
+            else if (script.readToRAM || script.isInline()) {
+                sources[i] = ScriptSource::create(script, utf8[i] != 0);
+                if (sources[i] == nullptr) {
+                    errors[i] = QString("Could not add script %1: File '%2' "
+                                        "does not open or is empty.")
+                            .arg(script.id).arg(script.scriptPath);
+                }
+            }
+        }
+    };
+    for (std::size_t i = 0; i < added.size(); ++i) {
+        if (!conf_.hasInterpreter(added[i]->scriptLanguage)) {
+            errors[i] = QString("Could not add script '%1': No suitable "
+                                "interpreter for language '%2'.")
+                    .arg(added[i]->id).arg(added[i]->scriptLanguage);
+        }
+        else if (!this->supportsEntryPoint(*added[i])) {
+            errors[i] = QString("Could not add script '%1': Interpreter for '%2' "
+                                "does not support entry points.")
+                    .arg(added[i]->id).arg(added[i]->scriptLanguage);
+        }
+        utf8[i] = this->prefersUtf8(added[i]->scriptLanguage);
+    }
+
+    std::size_t threads = std::min<std::size_t>(
+                std::max(1u, std::thread::hardware_concurrency()),
+                added.size() / SCRIPTS_PER_THREAD + 1);
+    std::size_t slice = (added.size() + threads - 1) / threads;
+    std::vector<std::thread> workers;
+    for (std::size_t i = 1; i < threads; ++i) {
+        std::size_t begin = std::min(added.size(), i * slice);
+        std::size_t end = std::min(added.size(), begin + slice);
+        workers.push_back(std::thread(validate, begin, end));
+    }
+    validate(0, std::min(added.size(), slice));
+    for (auto it = workers.begin(); it != workers.end(); ++it) {
+        it->join();
+    }
+
+    // Report all errors, one per line, and make no changes if any entry failed.
+    QStringList failures;
+    for (std::size_t i = 0; i < errors.size(); ++i) {
+        if (!errors[i].isEmpty()) {
+            failures.append(errors[i]);
+        }
+    }
+    if (!failures.isEmpty()) {
+        errorStr_ = QString("Could not add %1 scripts: %2 invalid.\n%3")
+                .arg(lastIndex.size()).arg(failures.size()).arg(failures.join('\n'));
+        logMsg(errorString());
+        return false;
+    }
+
+    // Apply.
+    std::size_t replaced = 0;
+    for (std::size_t i = 0; i < added.size(); ++i) {
+        const ScriptEntry& script = *added[i];
+        if (sources[i] != nullptr) {
+            std::shared_ptr<ScriptSource> source = pool_.intern(sources[i]);
+            this->forgetScriptState(script.id, false);
+            scripts_[script.id] = source;
+        }
+        else {
+            this->forgetScriptState(script.id, false);
+        }
+        if (conf_.hasScript(script.id)) {
+            ++replaced;
+        }
+        conf_.addScript(script);
+    }
+    logMsg(LogMessage("Scripts added: %1 new, %2 replaced, %3 already existed.")
+           .arg(unsigned(added.size() - replaced)).arg(unsigned(replaced))
+           .arg(unsigned(unchanged)));
+    return true;
+}
+
+
+void SerialScriptEmbedder::removeScripts(const std::vector<unsigned>& scriptIds)
+{
+    std::size_t removed = 0;
+    for (auto it = scriptIds.begin(); it != scriptIds.end(); ++it) {
+        if (conf_.hasScript(*it)) {
+            this->forgetScriptState(*it, true);
+            conf_.removeScript(*it);
+            ++removed;
+        }
+    }
+    this->logMsg(LogMessage("Scripts removed: %1 removed, %2 did not exist.")
+                 .arg(unsigned(removed)).arg(unsigned(scriptIds.size() - removed)));
 }
 
 
@@ -198,7 +584,7 @@ bool SerialScriptEmbedder::addInterpreter(const InterpreterEntry& interpreter)
     auto it = loaders_.find(interpreter.scriptLanguage);
     if (it != loaders_.end()) {
         if (it->second->getInterpreterEntry() == interpreter) {
-            logMsg(QString("Interpreter for '%1' already exists.")
+            logMsg(LogMessage("Interpreter for '%1' already exists.")
                    .arg(interpreter.scriptLanguage) );
             return true;
         }
@@ -222,17 +608,18 @@ bool SerialScriptEmbedder::addInterpreter(const InterpreterEntry& interpreter)
 
     // Unload old interpreter
     if (it != loaders_.end()){
+        this->forgetPrepared(interpreter.scriptLanguage);
         interpreters_.erase(interpreter.scriptLanguage);
         it->second->unloadPlugin();
     }
 
     // Replace old interpreter or add new one.
     if (it != loaders_.end()) {
-        logMsg(QString("Interpreter for '%1' replaced.")
+        logMsg(LogMessage("Interpreter for '%1' replaced.")
                .arg(interpreter.scriptLanguage) );
     }
     else {
-        logMsg(QString("Interpreter for '%1' added.")
+        logMsg(LogMessage("Interpreter for '%1' added.")
                .arg(interpreter.scriptLanguage) );
     }
 
@@ -250,29 +637,209 @@ void SerialScriptEmbedder::setLogger(Logger* logger)
 }
 
 
-void SerialScriptEmbedder::logMsg(const QString& msg)
+void SerialScriptEmbedder::setBatchLogger(BatchLogger* logger,
+                                          unsigned maxBatchSize,
+                                          unsigned maxDelay)
+{
+    Q_ASSERT(maxBatchSize > 0);
+    this->flushResults();
+    batchLogger_ = logger;
+    maxBatchSize_ = maxBatchSize;
+    maxBatchDelay_ = maxDelay;
+    batch_.reserve(maxBatchSize);
+}
+
+
+MetricsSnapshot SerialScriptEmbedder::metrics() const
+{
+    return metrics_.snapshot();
+}
+
+
+void SerialScriptEmbedder::setTracer(ExecutionTracer* tracer)
+{
+    tracer_ = tracer;
+}
+
+
+const FlightRecorder& SerialScriptEmbedder::flightRecorder() const
+{
+    return flightRecorder_;
+}
+
+
+void SerialScriptEmbedder::flushResults()
+{
+    if (batch_.empty()) return;
+
+    batchLogger_->scriptsFinished(batch_.data(), batch_.size());
+    batch_.clear();
+}
+
+
+void SerialScriptEmbedder::flushExpired()
+{
+    if (!batch_.empty() && batchTimer_.hasExpired(maxBatchDelay_)) {
+        this->flushResults();
+    }
+}
+
+
+void SerialScriptEmbedder::reportResult(const ScriptEntry& script,
+                                        const QStringList& params,
+                                        const ScriptInterpreter::ScriptRunResult& result,
+                                        ExecutionStats& stats)
+{
+    qint64 duration = stats.timer.nsecsElapsed();
+    bool failed = result.result == ScriptInterpreter::FAILURE;
+    this->recordMetrics(script, failed, duration, stats);
+    flightRecorder_.record(script.id, qHash(params), duration, result.result,
+                           failed ? ScriptResultRecord::SCRIPT_ERROR : ScriptResultRecord::NONE,
+                           stats.interpreter);
+
+    if (logger_ != nullptr) {
+        if (result.result == ScriptInterpreter::FAILURE){
+            logger_->scriptFailed(script, params, result.errorString);
+        } else {
+            logger_->scriptExecuted(script, params, result.returnValue);
+        }
+        stats.timing.log = stats.timer.nsecsElapsed() - duration;
+        logger_->scriptTimed(script, stats.timing);
+        this->trace(ExecutionTracer::LOG, script, stats,
+                    duration, duration + stats.timing.log);
+    }
+
+    if (batchLogger_ != nullptr) {
+        ScriptResultRecord record;
+        record.scriptId = script.id;
+        record.status = result.result;
+        record.returnValue = failed ? 0 : result.returnValue;
+        record.duration = duration;
+        record.errorCode = failed ? ScriptResultRecord::SCRIPT_ERROR : ScriptResultRecord::NONE;
+        record.timing = stats.timing;
+        this->addResultRecord(record);
+    }
+}
+
+
+void SerialScriptEmbedder::reportFailure(const ScriptEntry& script,
+                                         const QStringList& params,
+                                         ScriptResultRecord::ErrorCode error,
+                                         const LogMessage& msg,
+                                         ExecutionStats& stats)
+{
+    qint64 duration = stats.timer.nsecsElapsed();
+    bool exists = error != ScriptResultRecord::NO_SUCH_SCRIPT;
+    if (exists) {
+        this->recordMetrics(script, true, duration, stats);
+    }
+    flightRecorder_.record(script.id, qHash(params), duration,
+                           ScriptInterpreter::FAILURE, error, stats.interpreter);
+
+    if (logger_ != nullptr) {
+        logger_->scriptFailed(script, params, msg.toString());
+        stats.timing.log = stats.timer.nsecsElapsed() - duration;
+        if (exists) {
+            logger_->scriptTimed(script, stats.timing);
+        }
+        this->trace(ExecutionTracer::LOG, script, stats,
+                    duration, duration + stats.timing.log);
+    }
+
+    if (batchLogger_ != nullptr) {
+        ScriptResultRecord record;
+        record.scriptId = script.id;
+        record.status = ScriptInterpreter::FAILURE;
+        record.returnValue = 0;
+        record.duration = duration;
+        record.errorCode = error;
+        record.timing = stats.timing;
+        this->addResultRecord(record);
+    }
+}
+
+
+void SerialScriptEmbedder::recordMetrics(const ScriptEntry& script,
+                                         bool failed,
+                                         qint64 duration,
+                                         const ExecutionStats& stats)
+{
+    MetricsRegistry::Sample sample;
+    sample.failed = failed;
+    sample.duration = duration;
+    sample.queueWait = -1; // Scripts are not queued.
+    sample.sourceLoad = stats.sourceLoad;
+    metrics_.record(script.id, script.scriptLanguage, sample);
+}
+
+
+void SerialScriptEmbedder::addResultRecord(const ScriptResultRecord& record)
+{
+    if (batch_.empty()) {
+        batchTimer_.start();
+    }
+    batch_.push_back(record);
+
+    if (batch_.size() >= maxBatchSize_ ||
+            batchTimer_.hasExpired(maxBatchDelay_)) {
+        this->flushResults();
+    }
+}
+
+
+void SerialScriptEmbedder::trace(ExecutionTracer::Phase phase,
+                                 const ScriptEntry& script,
+                                 const ExecutionStats& stats,
+                                 qint64 begin,
+                                 qint64 end)
+{
+    if (tracer_ == nullptr) return;
+
+    tracer_->record(phase, script.id, stats.interpreter, script.scriptLanguage,
+                    stats.traceOrigin + begin, stats.traceOrigin + end);
+}
+
+
+void SerialScriptEmbedder::logMsg(const LogMessage& msg)
 {
     if (logger_ != nullptr){
-        logger_->logMessage(msg);
+        logger_->logRecord(msg);
     }
 }
 
 
-QString SerialScriptEmbedder::readScript(const QString& path)
+bool SerialScriptEmbedder::prefersUtf8(const QString& language) const
+{
+    auto it = interpreters_.find(language);
+    return it != interpreters_.end() && it->second->prefersUtf8();
+}
+
+
+bool SerialScriptEmbedder::supportsEntryPoint(const ScriptEntry& script) const
+{
+    if (script.entryPoint.isEmpty()) {
+        return true;
+    }
+    auto it = interpreters_.find(script.scriptLanguage);
+    return it != interpreters_.end() && it->second->supportsEntryPoints();
+}
+
+
+QByteArray SerialScriptEmbedder::readFile(const QString& path)
 {
     QFile f(path);
     if (!f.open(QFile::ReadOnly)){
-        return QString();
+        return QByteArray();
     }
-    QString script = f.readAll();
+    QByteArray contents = f.readAll();
     f.close();
-    return script;
+    return contents;
 }
 
 
 bool SerialScriptEmbedder::loadPlugins()
 {
-    std::map<QString, InterpreterEntry> entries = conf_.interpreters();
+    const std::map<QString, InterpreterEntry>& entries = conf_.interpreters();
 
     for (auto it = entries.begin(); it != entries.end(); ++it){
         loaders_[it->first] = std::shared_ptr<InterpreterLoader>(new InterpreterLoader(it->second));
@@ -297,10 +864,260 @@ bool SerialScriptEmbedder::loadPlugins()
 }
 
 
+void SerialScriptEmbedder::refreshSource(const ScriptEntry& script,
+                                         bool utf8,
+                                         ExecutionStats& stats)
+{
+    auto resident = scripts_.find(script.id);
+    SourceStamp& stamp = stamps_[script.id];
+    qint64 now = clock_.elapsed();
+    if (resident != scripts_.end() && now - stamp.checked < script.checkInterval) {
+        return;
+    }
+
+    // Status is read before the file, so that changes made while reading
+    // are detected on next check.
+    qint64 loadStart = stats.timer.nsecsElapsed();
+    FileStamp current = FileStamp::read(script.scriptPath);
+    stamp.checked = now;
+    if (resident != scripts_.end()) {
+        if (current == stamp.file) return;
+
+        this->releaseSource(script.id);
+        this->releasePrepared(script.id);
+    }
+
+    // File may change while it is in use, so it is not mapped.
+    ScriptEntry entry = script;
+    if (entry.storage == ScriptEntry::MAPPED) {
+        entry.storage = ScriptEntry::COPY;
+    }
+    std::shared_ptr<ScriptSource> source = ScriptSource::create(entry, utf8);
+    if (source == nullptr) {
+        // Execution falls back to reading the file, which reports the error.
+        stamps_.erase(script.id);
+        return;
+    }
+    scripts_[script.id] = pool_.intern(source);
+    stamp.file = current;
+    stats.timing.load = stats.timer.nsecsElapsed() - loadStart;
+    stats.sourceLoad = stats.timing.load;
+    this->trace(ExecutionTracer::LOAD, script, stats, loadStart, loadStart + stats.sourceLoad);
+}
+
+
+void SerialScriptEmbedder::updateHeat(const ScriptEntry& script,
+                                      bool utf8,
+                                      ExecutionStats& stats)
+{
+    // Prepared scripts are not loaded again, so they gain nothing from RAM.
+    if (prepared_.find(script.id) != prepared_.end()) return;
+
+    qint64 now = clock_.elapsed();
+    double score = this->heat(script.id, now) + 1.0;
+    Heat& counter = heat_[script.id];
+    counter.score = score;
+    counter.updated = now;
+
+    // Demote scripts that have become cold, and forget idle scripts.
+    if (now - lastSweep_ >= qint64(PROMOTION_HALF_LIFE)) {
+        lastSweep_ = now;
+        for (auto it = heat_.begin(); it != heat_.end(); ) {
+            if (this->heat(it->first, now) >= DEMOTION_HEAT) {
+                ++it;
+                continue;
+            }
+            this->demote(it->first);
+            it = heat_.erase(it);
+        }
+    }
+
+    // Promoted source is used like a cached one.
+    ScriptEntry entry = script;
+    entry.checkInterval = 0;
+    auto promoted = promoted_.find(script.id);
+    if (promoted != promoted_.end()) {
+        this->refreshSource(entry, utf8, stats);
+        auto source = scripts_.find(script.id);
+        if (source == scripts_.end()) {
+            // File does not open any more.
+            this->demote(script.id);
+            return;
+        }
+        promotedMemory_ += source->second->memoryUsage() - promoted->second;
+        promoted->second = source->second->memoryUsage();
+        return;
+    }
+    if (score < PROMOTION_HEAT || now < heat_[script.id].retry) return;
+
+    // String takes at most two bytes per UTF-8 byte. If there is no room,
+    // promotion is retried after the next sweep or limit change.
+    qint64 size = QFileInfo(script.scriptPath).size() * (utf8 ? 1 : 2);
+    if (size > promotionLimit_ || !this->makeRoom(size, score, now)) {
+        heat_[script.id].retry = lastSweep_ + qint64(PROMOTION_HALF_LIFE);
+        return;
+    }
+
+    this->refreshSource(entry, utf8, stats);
+    auto source = scripts_.find(script.id);
+    if (source == scripts_.end()) return;
+
+    prefetcher_.cancel(script.id);
+    promoted_[script.id] = source->second->memoryUsage();
+    promotedMemory_ += promoted_[script.id];
+    logMsg(LogMessage("Script '%1' promoted to RAM.").arg(script.id));
+}
+
+
+double SerialScriptEmbedder::heat(unsigned scriptId, qint64 now) const
+{
+    auto it = heat_.find(scriptId);
+    if (it == heat_.end()) return 0.0;
+
+    return it->second.score *
+            std::exp2(-double(now - it->second.updated) / PROMOTION_HALF_LIFE);
+}
+
+
+bool SerialScriptEmbedder::makeRoom(qint64 size, double score, qint64 now)
+{
+    qint64 needed = promotedMemory_ + size - promotionLimit_;
+    if (needed <= 0) return true;
+
+    // Only scripts colder than the promoted one are demoted, coldest first,
+    // and only if they free enough room.
+    std::vector<std::pair<double, unsigned>> colder;
+    for (auto it = promoted_.begin(); it != promoted_.end(); ++it) {
+        double current = this->heat(it->first, now);
+        if (current < score) {
+            colder.push_back(std::make_pair(current, it->first));
+        }
+    }
+    std::sort(colder.begin(), colder.end());
+    std::size_t count = 0;
+    qint64 freed = 0;
+    while (count < colder.size() && freed < needed) {
+        freed += promoted_[colder[count++].second];
+    }
+    if (freed < needed) return false;
+
+    for (std::size_t i = 0; i < count; ++i) {
+        this->demote(colder[i].second);
+    }
+    return true;
+}
+
+
+void SerialScriptEmbedder::demote(unsigned scriptId)
+{
+    auto it = promoted_.find(scriptId);
+    if (it == promoted_.end()) return;
+
+    promotedMemory_ -= it->second;
+    promoted_.erase(it);
+    this->releaseSource(scriptId);
+    stamps_.erase(scriptId);
+    logMsg(LogMessage("Script '%1' demoted from RAM.").arg(scriptId));
+}
+
+
+void SerialScriptEmbedder::forgetHeat(unsigned scriptId)
+{
+    heat_.erase(scriptId);
+    auto it = promoted_.find(scriptId);
+    if (it != promoted_.end()) {
+        promotedMemory_ -= it->second;
+        promoted_.erase(it);
+    }
+}
+
+
+void SerialScriptEmbedder::forgetScriptState(unsigned scriptId, bool removed)
+{
+    this->releasePrepared(scriptId);
+    this->releaseSource(scriptId);
+    stamps_.erase(scriptId);
+    prefetcher_.cancel(scriptId);
+    this->forgetHeat(scriptId);
+
+    // Execution history is kept for replaced scripts.
+    if (removed) {
+        predictor_.forget(scriptId);
+        metrics_.remove(scriptId);
+    }
+}
+
+
+void SerialScriptEmbedder::releaseSource(unsigned scriptId)
+{
+    auto it = scripts_.find(scriptId);
+    if (it == scripts_.end()) return;
+
+    // Decompressed copies are dropped with the last script using the source.
+    std::shared_ptr<ScriptSource> source = it->second;
+    scripts_.erase(it);
+    if (source.use_count() == 1 && source->isCompressed()) {
+        sourceCache_.remove(cacheKey(source->hash(), true));
+        sourceCache_.remove(cacheKey(source->hash(), false));
+    }
+}
+
+
+void SerialScriptEmbedder::releasePrepared(unsigned scriptId)
+{
+    auto prepared = prepared_.find(scriptId);
+    if (prepared == prepared_.end()) return;
+
+    // Program is released when its last script is released.
+    unsigned handle = prepared->second;
+    prepared_.erase(prepared);
+    auto program = programs_.find(handle);
+    if (--program->second.users > 0) return;
+
+    auto it = interpreters_.find(program->second.language);
+    if (it != interpreters_.end()) {
+        it->second->releaseScript(handle);
+    }
+    programIndex_.erase(std::make_pair(program->second.language, program->second.hash));
+    programs_.erase(program);
+}
+
+
+void SerialScriptEmbedder::forgetPrepared(const QString& language)
+{
+    for (auto it = prepared_.begin(); it != prepared_.end(); ) {
+        if (programs_[it->second].language == language) {
+            it = prepared_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    for (auto it = programs_.begin(); it != programs_.end(); ) {
+        if (it->second.language == language) {
+            programIndex_.erase(std::make_pair(it->second.language, it->second.hash));
+            it = programs_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+
 void SerialScriptEmbedder::clearConfiguration()
 {
+    prepared_.clear();
+    programs_.clear();
+    programIndex_.clear();
+    pool_.clear();
     interpreters_.clear();
     scripts_.clear();
+    sourceCache_.clear();
+    stamps_.clear();
+    prefetcher_.clear();
+    predictor_.clear();
+    heat_.clear();
+    promoted_.clear();
+    promotedMemory_ = 0;
 
     for (auto it = loaders_.begin(); it != loaders_.end(); ++it) {
         it->second->unloadPlugin();
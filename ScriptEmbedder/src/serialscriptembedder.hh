@@ -11,6 +11,16 @@
 #include "scriptembedder.hh"
 #include "interpreterplugin.hh"
 #include "interpreterloader.hh"
+#include "metricsregistry.hh"
+#include "scriptsource.hh"
+#include "sourcecache.hh"
+#include "filestamp.hh"
+#include "sourceloader.hh"
+#include "sourcepool.hh"
+#include "successorpredictor.hh"
+#include <set>
+#include <vector>
+#include <QElapsedTimer>
 
 namespace ScriptEmbedderNS
 {
@@ -46,10 +56,21 @@ public:
     bool isValid() const;
     QString errorString() const;
     void execute(unsigned scriptId, const QStringList& params);
+    void prefetch(const std::vector<unsigned>& scriptIds);
+    void setPromotionLimit(qint64 memoryLimit);
+    void setPredictivePrefetch(bool enabled);
     bool addScript(const ScriptEntry& script);
     void removeScript(unsigned scriptId);
+    bool addScripts(const std::vector<ScriptEntry>& scripts);
+    void removeScripts(const std::vector<unsigned>& scriptIds);
     bool addInterpreter(const InterpreterEntry& interpreter);
     void setLogger(Logger* logger);
+    void setBatchLogger(BatchLogger* logger, unsigned maxBatchSize, unsigned maxDelay);
+    void flushResults();
+    void flushExpired();
+    MetricsSnapshot metrics() const;
+    void setTracer(ExecutionTracer* tracer);
+    const FlightRecorder& flightRecorder() const;
 
 
 private:
@@ -60,11 +81,100 @@ private:
     QString errorStr_;
     std::map<QString, std::shared_ptr<InterpreterLoader>> loaders_;
     std::map<QString, std::shared_ptr<ScriptInterpreter>> interpreters_;
-    std::map<unsigned, QString> scripts_;
+    std::map<unsigned, std::shared_ptr<ScriptSource>> scripts_;
 
-    void logMsg(const QString& msg);
-    QString readScript(const QString& path);
+    // Prepared context shared by scripts having identical source.
+    struct Program
+    {
+        QString language;
+        QByteArray hash;   // Hash of the source.
+        std::size_t users; // Number of scripts using the program.
+    };
+    std::map<unsigned, unsigned> prepared_; // Script id -> program handle.
+    std::map<unsigned, Program> programs_;  // Handle -> program.
+    std::map<std::pair<QString, QByteArray>, unsigned> programIndex_;
+    unsigned nextHandle_;
+    SourcePool pool_;
+
+    BatchLogger* batchLogger_;
+    unsigned maxBatchSize_;
+    unsigned maxBatchDelay_;
+    std::vector<ScriptResultRecord> batch_;
+    QElapsedTimer batchTimer_;
+    MetricsRegistry metrics_;
+    ExecutionTracer* tracer_;
+    FlightRecorder flightRecorder_;
+    SourceCache sourceCache_;
+
+    // File status of a cached on-demand source.
+    struct SourceStamp
+    {
+        FileStamp file;  // Status when source was read.
+        qint64 checked;  // clock_ time of the last check.
+    };
+    std::map<unsigned, SourceStamp> stamps_;
+    QElapsedTimer clock_;
+    SourceLoader prefetcher_;
+    SuccessorPredictor predictor_;
+    bool predictive_;
+
+    // Execution frequency of an on-demand script.
+    struct Heat
+    {
+        double score;   // Decaying execution count.
+        qint64 updated; // clock_ time when score was updated.
+        qint64 retry;   // clock_ time before which promotion is not retried.
+    };
+    std::map<unsigned, Heat> heat_;
+    std::map<unsigned, qint64> promoted_; // Memory usage of promoted sources.
+    qint64 promotionLimit_;
+    qint64 promotedMemory_;
+    qint64 lastSweep_;
+
+    // Measurements of a single execution.
+    struct ExecutionStats
+    {
+        QElapsedTimer timer;    // Started when execution begins.
+        qint64 sourceLoad;      // Source load time, or -1 if not loaded.
+        ExecutionTiming timing; // Phase durations.
+        const ScriptInterpreter* interpreter; // Executing interpreter.
+        qint64 traceOrigin;     // Tracer's time when execution begins.
+    };
+
+    void reportResult(const ScriptEntry& script,
+                      const QStringList& params,
+                      const ScriptInterpreter::ScriptRunResult& result,
+                      ExecutionStats& stats);
+    void reportFailure(const ScriptEntry& script,
+                       const QStringList& params,
+                       ScriptResultRecord::ErrorCode error,
+                       const LogMessage& msg,
+                       ExecutionStats& stats);
+    void recordMetrics(const ScriptEntry& script,
+                       bool failed,
+                       qint64 duration,
+                       const ExecutionStats& stats);
+    void addResultRecord(const ScriptResultRecord& record);
+    void trace(ExecutionTracer::Phase phase,
+               const ScriptEntry& script,
+               const ExecutionStats& stats,
+               qint64 begin,
+               qint64 end);
+    void logMsg(const LogMessage& msg);
+    void refreshSource(const ScriptEntry& script, bool utf8, ExecutionStats& stats);
+    void updateHeat(const ScriptEntry& script, bool utf8, ExecutionStats& stats);
+    double heat(unsigned scriptId, qint64 now) const;
+    bool makeRoom(qint64 size, double score, qint64 now);
+    void demote(unsigned scriptId);
+    void forgetHeat(unsigned scriptId);
+    void forgetScriptState(unsigned scriptId, bool removed);
+    void releaseSource(unsigned scriptId);
+    bool prefersUtf8(const QString& language) const;
+    bool supportsEntryPoint(const ScriptEntry& script) const;
+    QByteArray readFile(const QString& path);
     bool loadPlugins();
+    void releasePrepared(unsigned scriptId);
+    void forgetPrepared(const QString& language);
     void clearConfiguration();
 };
 
@@ -0,0 +1,113 @@
+/**
+ * @file
+ * @brief Implements the SourceCache class defined in sourcecache.hh.
+ * @author Perttu Paarlahti 2016.
+ */
+
+#include "sourcecache.hh"
+
+namespace ScriptEmbedderNS
+{
+
+SourceCache::SourceCache(qint64 capacity) :
+    capacity_(capacity), size_(0), entries_(), order_()
+{
+}
+
+
+bool SourceCache::find(const QByteArray& key, QByteArray& source)
+{
+    Entry* entry = this->use(key);
+    if (entry == nullptr || entry->utf8.isNull()) {
+        return false;
+    }
+    source = entry->utf8;
+    return true;
+}
+
+
+bool SourceCache::find(const QByteArray& key, QString& source)
+{
+    Entry* entry = this->use(key);
+    if (entry == nullptr || entry->text.isNull()) {
+        return false;
+    }
+    source = entry->text;
+    return true;
+}
+
+
+void SourceCache::insert(const QByteArray& key, const QByteArray& source)
+{
+    Entry* entry = this->add(key, source.size());
+    if (entry != nullptr) {
+        entry->utf8 = source;
+    }
+}
+
+
+void SourceCache::insert(const QByteArray& key, const QString& source)
+{
+    Entry* entry = this->add(key, qint64(source.size()) * qint64(sizeof(QChar)));
+    if (entry != nullptr) {
+        entry->text = source;
+    }
+}
+
+
+void SourceCache::remove(const QByteArray& key)
+{
+    auto it = entries_.find(key);
+    if (it != entries_.end()) {
+        size_ -= it->second.size;
+        order_.erase(it->second.position);
+        entries_.erase(it);
+    }
+}
+
+
+void SourceCache::clear()
+{
+    entries_.clear();
+    order_.clear();
+    size_ = 0;
+}
+
+
+qint64 SourceCache::size() const
+{
+    return size_;
+}
+
+
+SourceCache::Entry* SourceCache::use(const QByteArray& key)
+{
+    auto it = entries_.find(key);
+    if (it == entries_.end()) {
+        return nullptr;
+    }
+    order_.splice(order_.begin(), order_, it->second.position);
+    return &it->second;
+}
+
+
+SourceCache::Entry* SourceCache::add(const QByteArray& key, qint64 size)
+{
+    this->remove(key);
+    if (size > capacity_) {
+        return nullptr;
+    }
+    while (size_ + size > capacity_) {
+        QByteArray oldest = order_.back();
+        this->remove(oldest);
+    }
+
+    order_.push_front(key);
+    Entry& entry = entries_[key];
+    entry.size = size;
+    entry.position = order_.begin();
+    size_ += size;
+    return &entry;
+}
+
+} // namespace ScriptEmbedderNS
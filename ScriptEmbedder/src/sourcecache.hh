@@ -0,0 +1,114 @@
+/**
+ * @file
+ * @brief Defines the SourceCache class, a size-limited cache of
+ * decompressed script sources.
+ * @author Perttu Paarlahti 2016.
+ */
+
+#ifndef SOURCECACHE_HH
+#define SOURCECACHE_HH
+
+#include <QByteArray>
+#include <QString>
+#include <list>
+#include <map>
+
+namespace ScriptEmbedderNS
+{
+
+/**
+ * @brief Keeps recently used decompressed sources. Sources are identified
+ * by a key, such as hash of the compressed source, so that scripts sharing
+ * a source also share its decompressed copy. When total size of cached
+ * sources exceeds the capacity, least recently used sources are evicted.
+ * Each source is cached either as UTF-8 bytes or as a string, depending on
+ * what the interpreter uses.
+ */
+class SourceCache
+{
+public:
+
+    /**
+     * @brief Constructor.
+     * @param capacity Maximum total size of cached sources in bytes.
+     */
+    explicit SourceCache(qint64 capacity);
+
+    /**
+     * @brief Find cached UTF-8 source.
+     * @param key Source key.
+     * @param source Receives the source, if found.
+     * @return True, if source was cached as UTF-8.
+     * @post Found source becomes the most recently used one.
+     */
+    bool find(const QByteArray& key, QByteArray& source);
+
+    /**
+     * @brief Find cached string source.
+     * @param key Source key.
+     * @param source Receives the source, if found.
+     * @return True, if source was cached as a string.
+     * @post Found source becomes the most recently used one.
+     */
+    bool find(const QByteArray& key, QString& source);
+
+    /**
+     * @brief Cache UTF-8 source, replacing previous source with the same key.
+     * @param key Source key.
+     * @param source Decompressed source.
+     * @post Source is cached unless it is larger than capacity. Least
+     * recently used sources are evicted to fit it.
+     */
+    void insert(const QByteArray& key, const QByteArray& source);
+
+    /**
+     * @brief Cache string source, replacing previous source with the same key.
+     * @param key Source key.
+     * @param source Decompressed source.
+     * @post Source is cached unless it is larger than capacity. Least
+     * recently used sources are evicted to fit it.
+     */
+    void insert(const QByteArray& key, const QString& source);
+
+    /**
+     * @brief Remove a source.
+     * @param key Source key.
+     * @post Source is not cached.
+     */
+    void remove(const QByteArray& key);
+
+    /**
+     * @brief Remove all sources.
+     * @post Cache is empty.
+     */
+    void clear();
+
+    /**
+     * @brief Get total size of cached sources.
+     * @return Size in bytes.
+     */
+    qint64 size() const;
+
+
+private:
+
+    struct Entry
+    {
+        QByteArray utf8;
+        QString text;
+        qint64 size;
+        std::list<QByteArray>::iterator position;
+    };
+
+    qint64 capacity_;
+    qint64 size_;
+    std::map<QByteArray, Entry> entries_;
+    std::list<QByteArray> order_;     // Most recently used first.
+
+    Entry* use(const QByteArray& key);
+    Entry* add(const QByteArray& key, qint64 size);
+};
+
+} // namespace ScriptEmbedderNS
+
+#endif // SOURCECACHE_HH
@@ -0,0 +1,166 @@
+/**
+ * @file
+ * @brief Implements the SourceLoader class defined in sourceloader.hh.
+ * @author Perttu Paarlahti 2016.
+ */
+
+#include "sourceloader.hh"
+#include <QFile>
+
+namespace ScriptEmbedderNS
+{
+
+SourceLoader::SourceLoader(unsigned threads, unsigned maxPending, qint64 maxAge) :
+    threadCount_(threads), maxPending_(maxPending), maxAge_(maxAge), clock_(),
+    serial_(0), stopping_(false), requests_(), queue_(), mutex_(), queued_(),
+    loaded_(), workers_()
+{
+    Q_ASSERT(threads > 0);
+    Q_ASSERT(maxPending > 0);
+    Q_ASSERT(maxAge >= 0);
+    clock_.start();
+}
+
+
+SourceLoader::~SourceLoader()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+        queue_.clear();
+    }
+    queued_.notify_all();
+    for (auto it = workers_.begin(); it != workers_.end(); ++it) {
+        it->join();
+    }
+}
+
+
+void SourceLoader::request(unsigned scriptId, const QString& path)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = requests_.find(scriptId);
+        if (it != requests_.end() && it->second.path == path &&
+                clock_.elapsed() - it->second.requested <= maxAge_) {
+            return;
+        }
+        if (it == requests_.end() && requests_.size() >= maxPending_) {
+            // Sources that were never taken would otherwise fill the loader.
+            auto oldest = requests_.begin();
+            for (auto req = requests_.begin(); req != requests_.end(); ++req) {
+                if (req->second.serial < oldest->second.serial) {
+                    oldest = req;
+                }
+            }
+            requests_.erase(oldest);
+        }
+
+        Request& req = requests_[scriptId];
+        req.path = path;
+        req.contents.clear();
+        req.serial = ++serial_;
+        req.requested = clock_.elapsed();
+        req.started = false;
+        req.done = false;
+        queue_.push_back(std::make_pair(scriptId, req.serial));
+        if (workers_.empty()) {
+            for (unsigned i = 0; i < threadCount_; ++i) {
+                workers_.push_back(std::thread(&SourceLoader::run, this));
+            }
+        }
+    }
+    queued_.notify_one();
+}
+
+
+bool SourceLoader::take(unsigned scriptId, QByteArray& contents)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto it = requests_.find(scriptId);
+    if (it == requests_.end()) {
+        return false;
+    }
+    if (clock_.elapsed() - it->second.requested > maxAge_ || !it->second.started) {
+        // Queued item is skipped by workers once request is gone.
+        requests_.erase(it);
+        return false;
+    }
+    // Request cannot be replaced or removed while waiting, as only the
+    // executing thread does that.
+    loaded_.wait(lock, [it]() { return it->second.done; });
+    contents = it->second.contents;
+    requests_.erase(it);
+    return true;
+}
+
+
+void SourceLoader::cancel(unsigned scriptId)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    requests_.erase(scriptId);
+}
+
+
+void SourceLoader::clear()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    requests_.clear();
+    queue_.clear();
+}
+
+
+std::size_t SourceLoader::pending() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return requests_.size();
+}
+
+
+std::size_t SourceLoader::loaded() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::size_t count = 0;
+    for (auto it = requests_.begin(); it != requests_.end(); ++it) {
+        if (it->second.done) ++count;
+    }
+    return count;
+}
+
+
+void SourceLoader::run()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        queued_.wait(lock, [this]() { return stopping_ || !queue_.empty(); });
+        if (stopping_) return;
+
+        std::pair<unsigned, unsigned long long> item = queue_.front();
+        queue_.pop_front();
+        auto it = requests_.find(item.first);
+        if (it == requests_.end() || it->second.serial != item.second) {
+            // Cancelled or replaced.
+            continue;
+        }
+        QString path = it->second.path;
+        it->second.started = true;
+
+        lock.unlock();
+        QByteArray contents;
+        QFile f(path);
+        if (f.open(QFile::ReadOnly)) {
+            contents = f.readAll();
+        }
+        lock.lock();
+
+        // Request may have been cancelled or replaced during the read.
+        it = requests_.find(item.first);
+        if (it != requests_.end() && it->second.serial == item.second) {
+            it->second.contents = contents;
+            it->second.done = true;
+            loaded_.notify_all();
+        }
+    }
+}
+
+} // namespace ScriptEmbedderNS
@@ -0,0 +1,130 @@
+/**
+ * @file
+ * @brief Defines the SourceLoader class, that reads script source files
+ * in background threads ahead of their execution.
+ * @author Perttu Paarlahti 2016.
+ */
+
+#ifndef SOURCELOADER_HH
+#define SOURCELOADER_HH
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QString>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ScriptEmbedderNS
+{
+
+/**
+ * @brief Reads source files in a small pool of background threads.
+ * Executing thread requests sources of scripts that are about to be
+ * executed, and takes the contents when executing them. Reads of several
+ * files overlap each other and the execution of other scripts, which hides
+ * the latency of slow storage. Threads are started on first request.
+ */
+class SourceLoader
+{
+public:
+
+    /**
+     * @brief Constructor.
+     * @param threads Number of reading threads.
+     * @param maxPending Maximum number of requested sources kept at once.
+     * @param maxAge Time in milliseconds after which a requested source is
+     * no longer used, as the file may have changed since it was read.
+     * @pre threads > 0, maxPending > 0, maxAge >= 0.
+     */
+    SourceLoader(unsigned threads, unsigned maxPending, qint64 maxAge);
+
+    /**
+     * @brief Destructor. Waits for reads in progress and stops the threads.
+     */
+    ~SourceLoader();
+
+    SourceLoader(const SourceLoader&) = delete;
+    SourceLoader& operator=(const SourceLoader&) = delete;
+
+    /**
+     * @brief Request reading a source file in background.
+     * @param scriptId Script id.
+     * @param path Path to the source file.
+     * @post Earlier request for the same script is replaced. If maxPending
+     * sources are already requested, the oldest request is dropped.
+     */
+    void request(unsigned scriptId, const QString& path);
+
+    /**
+     * @brief Take requested source. If source is being read, waits until it
+     * is ready. If reading has not started yet, caller is expected to read
+     * the file itself, as that is faster than waiting for a free thread.
+     * @param scriptId Script id.
+     * @param contents Receives file contents. Empty, if file did not open
+     * or is empty.
+     * @return True, if source was read. False, if there is no request
+     * for the script, reading has not started, or request is older than
+     * maxAge.
+     * @post Request is removed.
+     */
+    bool take(unsigned scriptId, QByteArray& contents);
+
+    /**
+     * @brief Cancel request. Does nothing if script has not been requested.
+     * @param scriptId Script id.
+     */
+    void cancel(unsigned scriptId);
+
+    /**
+     * @brief Cancel all requests.
+     */
+    void clear();
+
+    /**
+     * @brief Get the number of requested sources not yet taken.
+     * @return Request count.
+     */
+    std::size_t pending() const;
+
+    /**
+     * @brief Get the number of requested sources that have been read.
+     * @return Number of read sources not yet taken.
+     */
+    std::size_t loaded() const;
+
+
+private:
+
+    struct Request
+    {
+        QString path;
+        QByteArray contents;
+        unsigned long long serial; // Distinguishes replaced requests.
+        qint64 requested;          // clock_ time of the request.
+        bool started;              // Worker is reading the file.
+        bool done;
+    };
+
+    void run();
+
+    unsigned threadCount_;
+    unsigned maxPending_;
+    qint64 maxAge_;
+    QElapsedTimer clock_;
+    unsigned long long serial_;
+    bool stopping_;
+    std::map<unsigned, Request> requests_;
+    std::deque<std::pair<unsigned, unsigned long long>> queue_;
+    mutable std::mutex mutex_;
+    std::condition_variable queued_;
+    std::condition_variable loaded_;
+    std::vector<std::thread> workers_;
+};
+
+} // namespace ScriptEmbedderNS
+
+#endif // SOURCELOADER_HH
@@ -0,0 +1,69 @@
+/**
+ * @file
+ * @brief Implements the SourcePool class defined in sourcepool.hh.
+ * @author Perttu Paarlahti 2016.
+ */
+
+#include "sourcepool.hh"
+#include <algorithm>
+
+namespace ScriptEmbedderNS
+{
+
+namespace
+{
+// Released sources are not pruned from smaller pools.
+const std::size_t MIN_PRUNE_SIZE = 64;
+}
+
+
+SourcePool::SourcePool() :
+    sources_(), pruneAt_(MIN_PRUNE_SIZE)
+{
+}
+
+
+std::shared_ptr<ScriptSource> SourcePool::intern(const std::shared_ptr<ScriptSource>& source)
+{
+    Q_ASSERT(source != nullptr);
+    std::weak_ptr<ScriptSource>& entry = sources_[source->hash()];
+    std::shared_ptr<ScriptSource> existing = entry.lock();
+    if (existing != nullptr) {
+        return existing;
+    }
+    entry = source;
+
+    // Prune released sources when pool has doubled since last pruning.
+    if (sources_.size() >= pruneAt_) {
+        for (auto it = sources_.begin(); it != sources_.end(); ) {
+            if (it->second.expired()) {
+                it = sources_.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        pruneAt_ = std::max(MIN_PRUNE_SIZE, 2 * sources_.size());
+    }
+    return source;
+}
+
+
+std::size_t SourcePool::size() const
+{
+    std::size_t count = 0;
+    for (auto it = sources_.begin(); it != sources_.end(); ++it) {
+        if (!it->second.expired()) {
+            ++count;
+        }
+    }
+    return count;
+}
+
+
+void SourcePool::clear()
+{
+    sources_.clear();
+    pruneAt_ = MIN_PRUNE_SIZE;
+}
+
+} // namespace ScriptEmbedderNS
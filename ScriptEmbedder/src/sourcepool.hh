@@ -0,0 +1,62 @@
+/**
+ * @file
+ * @brief Defines the SourcePool class, that shares identical script sources
+ * between scripts.
+ * @author Perttu Paarlahti 2016.
+ */
+
+#ifndef SOURCEPOOL_HH
+#define SOURCEPOOL_HH
+
+#include "scriptsource.hh"
+#include <map>
+#include <memory>
+
+namespace ScriptEmbedderNS
+{
+
+/**
+ * @brief Deduplicates script sources by their hash. Scripts having identical
+ * sources (same file registered under several ids, or copies of a template)
+ * share one ScriptSource. Pool does not own sources: source is released when
+ * the last script using it is removed.
+ */
+class SourcePool
+{
+public:
+
+    /**
+     * @brief Constructor. Creates empty pool.
+     */
+    SourcePool();
+
+    /**
+     * @brief Get shared source identical to the given one.
+     * @param source New source.
+     * @return Existing source having the same hash, or source itself if
+     * there is no such source. In latter case, source is added to the pool.
+     * @pre source != nullptr.
+     */
+    std::shared_ptr<ScriptSource> intern(const std::shared_ptr<ScriptSource>& source);
+
+    /**
+     * @brief Get number of distinct sources in use.
+     * @return Source count.
+     */
+    std::size_t size() const;
+
+    /**
+     * @brief Forget all sources.
+     */
+    void clear();
+
+
+private:
+
+    std::map<QByteArray, std::weak_ptr<ScriptSource>> sources_;
+    std::size_t pruneAt_; // Pool size when released sources are pruned.
+};
+
+} // namespace ScriptEmbedderNS
+
+#endif // SOURCEPOOL_HH
@@ -0,0 +1,149 @@
+/**
+ * @file
+ * @brief Implements the SuccessorPredictor class defined in successorpredictor.hh.
+ * @author Perttu Paarlahti 2016.
+ */
+
+#include "successorpredictor.hh"
+#include <algorithm>
+
+namespace ScriptEmbedderNS
+{
+
+namespace
+{
+// Successors kept per script.
+const std::size_t MAX_SUCCESSORS = 8;
+
+// Counts of a script are halved when their sum exceeds this.
+const unsigned MAX_TOTAL = 256;
+
+// Minimum probability of a predicted script, and maximum number of
+// predicted scripts.
+const double MIN_PROBABILITY = 0.25;
+const std::size_t MAX_PREDICTIONS = 4;
+}
+
+
+SuccessorPredictor::SuccessorPredictor(qint64 window) :
+    nodes_(), window_(window), hasPrevious_(false), previous_(0), previousTime_(0)
+{
+    Q_ASSERT(window >= 0);
+}
+
+
+void SuccessorPredictor::record(unsigned scriptId, qint64 time)
+{
+    if (hasPrevious_ && previous_ != scriptId && time - previousTime_ <= window_) {
+        this->addSuccessor(nodes_[previous_], scriptId);
+    }
+    hasPrevious_ = true;
+    previous_ = scriptId;
+    previousTime_ = time;
+}
+
+
+std::vector<unsigned> SuccessorPredictor::predict(unsigned scriptId) const
+{
+    // Direct successors, and their successors.
+    std::vector<std::pair<double, unsigned>> direct;
+    this->likely(scriptId, 1.0, direct);
+    std::vector<std::pair<double, unsigned>> candidates = direct;
+    for (auto it = direct.begin(); it != direct.end(); ++it) {
+        this->likely(it->second, it->first, candidates);
+    }
+    std::stable_sort(candidates.begin(), candidates.end(),
+                     [](const std::pair<double, unsigned>& a,
+                        const std::pair<double, unsigned>& b) { return a.first > b.first; });
+
+    std::vector<unsigned> result;
+    for (auto it = candidates.begin();
+         it != candidates.end() && result.size() < MAX_PREDICTIONS; ++it) {
+        if (it->second != scriptId &&
+                std::find(result.begin(), result.end(), it->second) == result.end()) {
+            result.push_back(it->second);
+        }
+    }
+    return result;
+}
+
+
+void SuccessorPredictor::forget(unsigned scriptId)
+{
+    nodes_.erase(scriptId);
+    for (auto node = nodes_.begin(); node != nodes_.end(); ++node) {
+        std::vector<Successor>& successors = node->second.successors;
+        for (auto it = successors.begin(); it != successors.end(); ++it) {
+            if (it->id == scriptId) {
+                node->second.total -= it->count;
+                successors.erase(it);
+                break;
+            }
+        }
+    }
+    if (previous_ == scriptId) {
+        hasPrevious_ = false;
+    }
+}
+
+
+void SuccessorPredictor::clear()
+{
+    nodes_.clear();
+    hasPrevious_ = false;
+}
+
+
+void SuccessorPredictor::addSuccessor(Node& node, unsigned scriptId)
+{
+    std::vector<Successor>& successors = node.successors;
+    auto it = std::find_if(successors.begin(), successors.end(),
+                           [scriptId](const Successor& s) { return s.id == scriptId; });
+    if (it != successors.end()) {
+        ++it->count;
+    }
+    else if (successors.size() < MAX_SUCCESSORS) {
+        successors.push_back(Successor{scriptId, 1});
+    }
+    else {
+        // Replace the least frequent successor.
+        auto least = std::min_element(successors.begin(), successors.end(),
+                                      [](const Successor& a, const Successor& b) {
+            return a.count < b.count;
+        });
+        node.total -= least->count;
+        *least = Successor{scriptId, 1};
+    }
+    ++node.total;
+
+    if (node.total > MAX_TOTAL) {
+        node.total = 0;
+        for (auto s = successors.begin(); s != successors.end(); ) {
+            s->count /= 2;
+            if (s->count == 0) {
+                s = successors.erase(s);
+            } else {
+                node.total += s->count;
+                ++s;
+            }
+        }
+    }
+}
+
+
+void SuccessorPredictor::likely(unsigned scriptId, double probability,
+                                std::vector<std::pair<double, unsigned>>& result) const
+{
+    auto node = nodes_.find(scriptId);
+    if (node == nodes_.end() || node->second.total == 0) return;
+
+    const std::vector<Successor>& successors = node->second.successors;
+    for (auto it = successors.begin(); it != successors.end(); ++it) {
+        double p = probability * it->count / node->second.total;
+        if (p >= MIN_PROBABILITY) {
+            result.push_back(std::make_pair(p, it->id));
+        }
+    }
+}
+
+} // namespace ScriptEmbedderNS
@@ -0,0 +1,93 @@
+/**
+ * @file
+ * @brief Defines the SuccessorPredictor class, that learns which scripts
+ * tend to follow each other.
+ * @author Perttu Paarlahti 2016.
+ */
+
+#ifndef SUCCESSORPREDICTOR_HH
+#define SUCCESSORPREDICTOR_HH
+
+#include <QtGlobal>
+#include <map>
+#include <vector>
+
+namespace ScriptEmbedderNS
+{
+
+/**
+ * @brief Records how often each script is executed soon after another one,
+ * and predicts scripts likely to be executed next. Only a few most frequent
+ * successors are kept per script, and old counts are halved periodically,
+ * so that predictions follow changes in execution patterns.
+ */
+class SuccessorPredictor
+{
+public:
+
+    /**
+     * @brief Constructor.
+     * @param window Maximum time between executions in milliseconds for
+     * the latter one to be counted as a successor.
+     * @pre window >= 0.
+     */
+    explicit SuccessorPredictor(qint64 window);
+
+    /**
+     * @brief Record execution of a script.
+     * @param scriptId Executed script.
+     * @param time Time of the execution in milliseconds from any fixed point.
+     * @post Script is counted as a successor of the previously recorded
+     * script, if it was executed within the window.
+     */
+    void record(unsigned scriptId, qint64 time);
+
+    /**
+     * @brief Predict scripts executed after a script. Also successors of
+     * likely successors are predicted, if they are likely enough.
+     * @param scriptId Script being executed.
+     * @return Likely successors, most likely first.
+     */
+    std::vector<unsigned> predict(unsigned scriptId) const;
+
+    /**
+     * @brief Forget history of a script.
+     * @param scriptId Script id.
+     * @post Script is neither predicted nor has predictions.
+     */
+    void forget(unsigned scriptId);
+
+    /**
+     * @brief Forget all history.
+     */
+    void clear();
+
+
+private:
+
+    struct Successor
+    {
+        unsigned id;
+        unsigned count;
+    };
+
+    struct Node
+    {
+        unsigned total; // Sum of successor counts.
+        std::vector<Successor> successors;
+    };
+
+    void addSuccessor(Node& node, unsigned scriptId);
+    void likely(unsigned scriptId, double probability,
+                std::vector<std::pair<double, unsigned>>& result) const;
+
+    std::map<unsigned, Node> nodes_;
+    qint64 window_;
+    bool hasPrevious_;
+    unsigned previous_;
+    qint64 previousTime_;
+};
+
+} // namespace ScriptEmbedderNS
+
+#endif // SUCCESSORPREDICTOR_HH
@@ -5,4 +5,5 @@ CONFIG += ordered
 SUBDIRS += \
     ScriptEmbedder \
     Tests \
+    Tools \
     Examples
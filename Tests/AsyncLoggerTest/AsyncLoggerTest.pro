@@ -0,0 +1,24 @@
+#-------------------------------------------------
+#
+# Project created by QtCreator 2016-06-12T14:21:05
+#
+#-------------------------------------------------
+
+QT       += testlib
+
+QT       -= gui
+
+TARGET = tst_asyncloggertest
+CONFIG   += console c++11
+CONFIG   -= app_bundle
+
+TEMPLATE = app
+
+INCLUDEPATH += ../../ScriptEmbedder/include
+
+SOURCES += tst_asyncloggertest.cc \
+           ../../ScriptEmbedder/src/asynclogger.cc \
+           ../../ScriptEmbedder/src/logger.cc \
+           ../../ScriptEmbedder/src/configuration.cc
+
+DEFINES += SRCDIR=\\\"$$PWD/\\\"
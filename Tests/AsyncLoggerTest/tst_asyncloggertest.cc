@@ -0,0 +1,242 @@
+/**
+ * @file
+ * @brief Unit tests for the AsyncLogger and LogMessage classes.
+ * @author Perttu Paarlahti 2016.
+ */
+
+#include <QString>
+#include <QtTest>
+#include <thread>
+#include "asynclogger.hh"
+
+
+/**
+ * @brief Stub implementation for the Logger interface.
+ * Records calls and the threads they were made from.
+ */
+class LoggerStub : public ScriptEmbedderNS::Logger
+{
+public:
+
+    // Members for verifying tests.
+    QStringList logMessages;
+    std::vector<std::pair<unsigned, int> > successes;
+    std::vector<std::pair<unsigned, QString> > failures;
+    std::vector<std::thread::id> threads;
+
+    LoggerStub() :
+        ScriptEmbedderNS::Logger(), logMessages(), successes(), failures(), threads() {}
+
+    virtual ~LoggerStub() {}
+
+    void logMessage(const QString& msg)
+    {
+        threads.push_back(std::this_thread::get_id());
+        logMessages.push_back(msg);
+    }
+
+    void scriptExecuted(const ScriptEmbedderNS::ScriptEntry& script,
+                        const QStringList& params, int returnValue)
+    {
+        Q_UNUSED(params);
+        threads.push_back(std::this_thread::get_id());
+        successes.push_back(std::make_pair(script.id, returnValue));
+    }
+
+    void scriptFailed(const ScriptEmbedderNS::ScriptEntry& script,
+                      const QStringList& params, const QString& errorMsg)
+    {
+        Q_UNUSED(params);
+        threads.push_back(std::this_thread::get_id());
+        failures.push_back(std::make_pair(script.id, errorMsg));
+    }
+};
+
+
+/**
+ * @brief Unit tests for the AsyncLogger class.
+ */
+class AsyncLoggerTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    AsyncLoggerTest();
+
+private Q_SLOTS:
+
+    /**
+     * @brief Test formatting LogMessages.
+     */
+    void logMessageTest();
+
+    /**
+     * @brief Test that records are delivered in order from the background thread.
+     */
+    void deliveryTest();
+
+    /**
+     * @brief Test posting from several threads with small ring buffers.
+     */
+    void multipleThreadsTest();
+
+    /**
+     * @brief Test that pending records are delivered on destruction.
+     */
+    void destructorTest();
+
+    /**
+     * @brief Test that flush delivers caller's records while other threads
+     * keep posting.
+     */
+    void concurrentFlushTest();
+};
+
+
+AsyncLoggerTest::AsyncLoggerTest()
+{
+}
+
+
+void AsyncLoggerTest::logMessageTest()
+{
+    using namespace ScriptEmbedderNS;
+    QCOMPARE(LogMessage().toString(), QString());
+    QCOMPARE(LogMessage("No arguments.").toString(), QString("No arguments."));
+    QCOMPARE(LogMessage(QString("Formatted.")).toString(), QString("Formatted."));
+    QCOMPARE(LogMessage("Script '%1' added.").arg(12u).toString(),
+             QString("Script '%1' added.").arg(12u));
+    QCOMPARE(LogMessage("'%1' for '%2' (%3).").arg("a").arg(3u).arg("b").toString(),
+             QString("'%1' for '%2' (%3).").arg("a").arg(3u).arg("b"));
+}
+
+
+void AsyncLoggerTest::deliveryTest()
+{
+    using namespace ScriptEmbedderNS;
+    LoggerStub target;
+    AsyncLogger logger(&target);
+
+    ScriptEntry script(3u, "script.js", "JavaScript");
+    logger.logMessage("first");
+    logger.scriptExecuted(script, QStringList{"a"}, 5);
+    logger.scriptFailed(script, QStringList{"b"}, "error");
+    logger.logRecord(LogMessage("Script '%1' removed.").arg(3u));
+    logger.flush();
+
+    QCOMPARE(target.logMessages.size(), QStringList::size_type(2));
+    QCOMPARE(target.logMessages.at(0), QString("first"));
+    QCOMPARE(target.logMessages.at(1), QString("Script '3' removed."));
+    QVERIFY(target.successes.size() == 1);
+    QCOMPARE(target.successes.at(0).first, 3u);
+    QCOMPARE(target.successes.at(0).second, 5);
+    QVERIFY(target.failures.size() == 1);
+    QCOMPARE(target.failures.at(0).second, QString("error"));
+
+    QVERIFY(target.threads.size() == 4);
+    for (auto it = target.threads.begin(); it != target.threads.end(); ++it){
+        QVERIFY(*it != std::this_thread::get_id());
+    }
+}
+
+
+void AsyncLoggerTest::multipleThreadsTest()
+{
+    using namespace ScriptEmbedderNS;
+    const unsigned THREADS = 4;
+    const int RECORDS = 1000;
+
+    LoggerStub target;
+    AsyncLogger logger(&target, 8);
+
+    std::vector<std::thread> threads;
+    for (unsigned t = 0; t < THREADS; ++t){
+        threads.push_back(std::thread([&logger, t, RECORDS]() {
+            ScriptEntry script(t, "script.js", "JavaScript");
+            for (int i = 0; i < RECORDS; ++i){
+                logger.scriptExecuted(script, QStringList(), i);
+            }
+        }));
+    }
+    for (auto it = threads.begin(); it != threads.end(); ++it){
+        it->join();
+    }
+    logger.flush();
+
+    // All records are delivered, and each thread's records are in order.
+    QCOMPARE(target.successes.size(), std::size_t(THREADS * RECORDS));
+    std::vector<int> next(THREADS, 0);
+    for (auto it = target.successes.begin(); it != target.successes.end(); ++it){
+        QCOMPARE(it->second, next.at(it->first));
+        ++next.at(it->first);
+    }
+}
+
+
+void AsyncLoggerTest::destructorTest()
+{
+    using namespace ScriptEmbedderNS;
+    LoggerStub target;
+    {
+        AsyncLogger logger(&target, 4);
+        for (unsigned i = 0; i < 100; ++i){
+            logger.logRecord(LogMessage("Message %1").arg(i));
+        }
+    } // Destructor is called.
+
+    QCOMPARE(target.logMessages.size(), QStringList::size_type(100));
+    QCOMPARE(target.logMessages.at(99), QString("Message 99"));
+}
+
+
+void AsyncLoggerTest::concurrentFlushTest()
+{
+    using namespace ScriptEmbedderNS;
+
+    // Counts records of the flushing thread. Other threads' records are
+    // delivered concurrently with the checks.
+    struct CountingLogger : public Logger
+    {
+        std::atomic<int> own;
+        CountingLogger() : Logger(), own(0) {}
+        void logMessage(const QString& msg) { if (msg == "own") ++own; }
+        void scriptExecuted(const ScriptEntry&, const QStringList&, int) {}
+        void scriptFailed(const ScriptEntry&, const QStringList&, const QString&) {}
+    };
+
+    CountingLogger target;
+    AsyncLogger logger(&target, 4);
+    std::atomic<bool> stop(false);
+    std::vector<std::thread> threads;
+    for (unsigned t = 0; t < 2; ++t){
+        threads.push_back(std::thread([&logger, &stop]() {
+            ScriptEntry script(0u, "script.js", "JavaScript");
+            while (!stop.load()){
+                logger.scriptExecuted(script, QStringList(), 0);
+            }
+        }));
+    }
+    int undelivered = 0;
+    for (int i = 1; i <= 200; ++i){
+        logger.logMessage("own");
+        logger.flush();
+        if (target.own.load() != i){
+            ++undelivered;
+        }
+    }
+    stop.store(true);
+    for (auto it = threads.begin(); it != threads.end(); ++it){
+        it->join();
+    }
+    QCOMPARE(undelivered, 0);
+
+    // Rings of exited threads are released, and logger still works.
+    logger.logMessage("own");
+    logger.flush();
+    QCOMPARE(target.own.load(), 201);
+}
+
+
+QTEST_APPLESS_MAIN(AsyncLoggerTest)
+
+#include "tst_asyncloggertest.moc"
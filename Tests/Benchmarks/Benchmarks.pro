@@ -0,0 +1,8 @@
+TEMPLATE = subdirs
+
+CONFIG += ordered
+
+SUBDIRS += \
+    NoOpInterpreterPlugin \
+    SpinInterpreterPlugin \
+    EmbedderBenchmark
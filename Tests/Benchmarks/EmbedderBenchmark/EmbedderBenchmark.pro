@@ -0,0 +1,43 @@
+#-------------------------------------------------
+#
+# Project created by QtCreator 2016-06-23T20:14:51
+#
+#-------------------------------------------------
+
+QT       += testlib
+
+QT       -= gui
+
+TARGET = tst_embedderbenchmark
+CONFIG   += console c++11
+CONFIG   -= app_bundle
+
+TEMPLATE = app
+
+INCLUDEPATH += \
+    ../../../ScriptEmbedder/include \
+    ../../../ScriptEmbedder/src \
+    ../../SerialScriptEmbedderTest/InterpreterTestPlugin
+
+SOURCES += \
+    tst_embedderbenchmark.cc \
+    ../../../ScriptEmbedder/src/serialscriptembedder.cc \
+    ../../../ScriptEmbedder/src/configuration.cc \
+    ../../../ScriptEmbedder/src/interpreterloader.cc \
+    ../../../ScriptEmbedder/src/logger.cc \
+    ../../../ScriptEmbedder/src/metricsregistry.cc \
+    ../../../ScriptEmbedder/src/executiontracer.cc \
+    ../../../ScriptEmbedder/src/flightrecorder.cc \
+    ../../../ScriptEmbedder/src/scriptsource.cc \
+    ../../../ScriptEmbedder/src/sourcecache.cc \
+    ../../../ScriptEmbedder/src/filestamp.cc \
+    ../../../ScriptEmbedder/src/sourceloader.cc \
+    ../../../ScriptEmbedder/src/sourcepool.cc \
+    ../../../ScriptEmbedder/src/successorpredictor.cc
+
+OTHER_FILES += \
+    testfiles/noop.txt \
+    testfiles/spin10.txt \
+    testfiles/spin100.txt
+
+DEFINES += SRCDIR=\\\"$$PWD/\\\"
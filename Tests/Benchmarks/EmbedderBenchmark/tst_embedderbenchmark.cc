@@ -0,0 +1,265 @@
+/**
+ * @file
+ * @brief Benchmarks for the hot paths of SerialScriptEmbedder and Configuration.
+ * Run with e.g. '-tickcounter' or '-callgrind' for more stable results.
+ * @author Perttu Paarlahti 2016.
+ */
+
+#include <QString>
+#include <QtTest>
+#include "serialscriptembedder.hh"
+#include "interpretertestplugin.hh"
+
+
+#ifdef Q_OS_WIN
+const QString PLUGIN_PATH = "../../SerialScriptEmbedderTest/InterpreterTestPlugin/debug/InterpreterTestPlugin.dll";
+const QString NOOP_PLUGIN_PATH = "../NoOpInterpreterPlugin/debug/NoOpInterpreterPlugin.dll";
+const QString SPIN_PLUGIN_PATH = "../SpinInterpreterPlugin/debug/SpinInterpreterPlugin.dll";
+#else
+const QString PLUGIN_PATH = "../../SerialScriptEmbedderTest/InterpreterTestPlugin/InterpreterTestPlugin.so";
+const QString NOOP_PLUGIN_PATH = "../NoOpInterpreterPlugin/NoOpInterpreterPlugin.so";
+const QString SPIN_PLUGIN_PATH = "../SpinInterpreterPlugin/SpinInterpreterPlugin.so";
+#endif
+
+const QString TEST_PATH = "../../../../ScriptEmbedder/Tests/SerialScriptEmbedderTest/SerialScriptEmbedderTest/testfiles/";
+const QString BENCHMARK_PATH = "../../../../ScriptEmbedder/Tests/Benchmarks/EmbedderBenchmark/testfiles/";
+
+
+/**
+ * @brief Benchmarks for SerialScriptEmbedder and Configuration.
+ */
+class EmbedderBenchmark : public QObject
+{
+    Q_OBJECT
+
+public:
+    EmbedderBenchmark();
+
+private Q_SLOTS:
+
+    /**
+     * @brief Make test plugin's scripts succeed.
+     */
+    void initTestCase();
+
+    /**
+     * @brief Measure execute() overhead for scripts in RAM and on disk.
+     * Uses the no-op interpreter, so that only embedder's work is measured.
+     */
+    void executeBenchmark();
+    void executeBenchmark_data();
+
+    /**
+     * @brief Measure execute() with scripts that keep the interpreter busy
+     * for a fixed time.
+     */
+    void spinBenchmark();
+    void spinBenchmark_data();
+
+    /**
+     * @brief Measure adding and removing a script.
+     */
+    void scriptChurnBenchmark();
+    void scriptChurnBenchmark_data();
+
+    /**
+     * @brief Measure reset() with growing number of scripts.
+     */
+    void resetBenchmark();
+    void resetBenchmark_data();
+
+    /**
+     * @brief Measure Configuration::isValid() with growing number of scripts.
+     */
+    void configurationValidityBenchmark();
+    void configurationValidityBenchmark_data();
+
+
+private:
+
+    ScriptEmbedderNS::Configuration createConfiguration(unsigned scripts, bool readToRAM);
+    ScriptEmbedderNS::Configuration createConfiguration(const ScriptEmbedderNS::InterpreterEntry& interpreter,
+                                                        const QString& scriptPath,
+                                                        bool readToRAM);
+};
+
+
+EmbedderBenchmark::EmbedderBenchmark()
+{
+}
+
+
+void EmbedderBenchmark::initTestCase()
+{
+    using namespace ScriptEmbedderNS;
+    QPluginLoader loader(PLUGIN_PATH);
+    InterpreterTestPlugin* plugin = ((InterpreterTestPlugin*)loader.instance());
+    QVERIFY2(plugin != nullptr, qPrintable(loader.errorString()));
+    plugin->result.result = ScriptInterpreter::SUCCESS;
+    plugin->result.returnValue = 0;
+}
+
+
+void EmbedderBenchmark::executeBenchmark()
+{
+    using namespace ScriptEmbedderNS;
+    QFETCH(bool, readToRAM);
+
+    InterpreterEntry interpreter("NoOp", NOOP_PLUGIN_PATH);
+    SerialScriptEmbedder embedder(this->createConfiguration(interpreter,
+                                                            BENCHMARK_PATH+"noop.txt",
+                                                            readToRAM));
+    QVERIFY(embedder.isValid());
+    QStringList params{"param1", "param2"};
+
+    QBENCHMARK {
+        embedder.execute(0u, params);
+    }
+}
+
+
+void EmbedderBenchmark::executeBenchmark_data()
+{
+    QTest::addColumn<bool>("readToRAM");
+
+    QTest::newRow("RAM") << true;
+    QTest::newRow("disk") << false;
+}
+
+
+void EmbedderBenchmark::spinBenchmark()
+{
+    using namespace ScriptEmbedderNS;
+    QFETCH(QString, script);
+
+    InterpreterEntry interpreter("Spin", SPIN_PLUGIN_PATH);
+    SerialScriptEmbedder embedder(this->createConfiguration(interpreter,
+                                                            BENCHMARK_PATH+script,
+                                                            true));
+    QVERIFY(embedder.isValid());
+
+    QBENCHMARK {
+        embedder.execute(0u);
+    }
+    QCOMPARE(embedder.metrics().scripts.at(0u).failures, quint64(0));
+}
+
+
+void EmbedderBenchmark::spinBenchmark_data()
+{
+    QTest::addColumn<QString>("script");
+
+    QTest::newRow("10 us") << "spin10.txt";
+    QTest::newRow("100 us") << "spin100.txt";
+}
+
+
+void EmbedderBenchmark::scriptChurnBenchmark()
+{
+    using namespace ScriptEmbedderNS;
+    QFETCH(bool, readToRAM);
+
+    SerialScriptEmbedder embedder(this->createConfiguration(1u, readToRAM));
+    QVERIFY(embedder.isValid());
+    ScriptEntry script(1u, TEST_PATH+"testscript.txt", "TestLanguage", readToRAM, 0u);
+
+    QBENCHMARK {
+        embedder.addScript(script);
+        embedder.removeScript(script.id);
+    }
+}
+
+
+void EmbedderBenchmark::scriptChurnBenchmark_data()
+{
+    QTest::addColumn<bool>("readToRAM");
+
+    QTest::newRow("RAM") << true;
+    QTest::newRow("disk") << false;
+}
+
+
+void EmbedderBenchmark::resetBenchmark()
+{
+    using namespace ScriptEmbedderNS;
+    QFETCH(unsigned, scripts);
+
+    // Scripts are loaded on demand, so that the results measure the cost of
+    // the embedder rather than the cost of reading the same file repeatedly.
+    Configuration conf = this->createConfiguration(scripts, false);
+    SerialScriptEmbedder embedder(conf);
+    QVERIFY(embedder.isValid());
+
+    QBENCHMARK {
+        embedder.reset(conf);
+    }
+}
+
+
+void EmbedderBenchmark::resetBenchmark_data()
+{
+    QTest::addColumn<unsigned>("scripts");
+
+    QTest::newRow("10 scripts") << 10u;
+    QTest::newRow("1k scripts") << 1000u;
+    QTest::newRow("100k scripts") << 100000u;
+}
+
+
+void EmbedderBenchmark::configurationValidityBenchmark()
+{
+    using namespace ScriptEmbedderNS;
+    QFETCH(unsigned, scripts);
+
+    Configuration conf = this->createConfiguration(scripts, false);
+    bool valid = false;
+
+    QBENCHMARK {
+        valid = conf.isValid();
+    }
+    QVERIFY(valid);
+}
+
+
+void EmbedderBenchmark::configurationValidityBenchmark_data()
+{
+    QTest::addColumn<unsigned>("scripts");
+
+    QTest::newRow("10 scripts") << 10u;
+    QTest::newRow("1k scripts") << 1000u;
+    QTest::newRow("100k scripts") << 100000u;
+}
+
+
+ScriptEmbedderNS::Configuration EmbedderBenchmark::createConfiguration(unsigned scripts,
+                                                                       bool readToRAM)
+{
+    using namespace ScriptEmbedderNS;
+    Configuration conf;
+    conf.setScriptAPI(std::shared_ptr<ScriptAPI>(new ScriptAPI()));
+    conf.addInterpreter(InterpreterEntry("TestLanguage", PLUGIN_PATH));
+    for (unsigned i = 0; i < scripts; ++i) {
+        conf.addScript(ScriptEntry(i, TEST_PATH+"testscript.txt", "TestLanguage", readToRAM, 0u));
+    }
+    return conf;
+}
+
+
+
+ScriptEmbedderNS::Configuration EmbedderBenchmark::createConfiguration(
+        const ScriptEmbedderNS::InterpreterEntry& interpreter,
+        const QString& scriptPath,
+        bool readToRAM)
+{
+    using namespace ScriptEmbedderNS;
+    Configuration conf;
+    conf.setScriptAPI(std::shared_ptr<ScriptAPI>(new ScriptAPI()));
+    conf.addInterpreter(interpreter);
+    conf.addScript(ScriptEntry(0u, scriptPath, interpreter.scriptLanguage, readToRAM, 0u));
+    return conf;
+}
+
+
+QTEST_APPLESS_MAIN(EmbedderBenchmark)
+
+#include "tst_embedderbenchmark.moc"
@@ -0,0 +1,11 @@
+QT += core
+QT -= gui
+CONFIG += c++11
+
+TEMPLATE = lib
+TARGET = NoOpInterpreterPlugin
+
+INCLUDEPATH += ../../../ScriptEmbedder/include
+
+HEADERS += \
+    noopinterpreterplugin.hh
@@ -0,0 +1,78 @@
+/**
+ * @file
+ * @brief Interpreter plugin that does no work, for measuring the overhead
+ * of ScriptEmbedder itself.
+ * @author Perttu Paarlahti 2016.
+ */
+
+#ifndef NOOPINTERPRETERPLUGIN_HH
+#define NOOPINTERPRETERPLUGIN_HH
+
+#include "interpreterplugin.hh"
+
+
+/**
+ * @brief ScriptInterpreter that returns success immediately without
+ * touching its inputs. Instances share no state, so they may run
+ * concurrently.
+ */
+class NoOpInterpreter : public ScriptEmbedderNS::ScriptInterpreter
+{
+public:
+
+    NoOpInterpreter() : ScriptEmbedderNS::ScriptInterpreter() {}
+
+    virtual ~NoOpInterpreter() {}
+
+    void SetScriptAPI(std::shared_ptr<ScriptEmbedderNS::ScriptAPI> api)
+    {
+        Q_UNUSED(api);
+    }
+
+    ScriptRunResult runScript(const QString& script, const QStringList& params)
+    {
+        Q_UNUSED(script);
+        Q_UNUSED(params);
+        ScriptRunResult result;
+        result.result = SUCCESS;
+        result.returnValue = 0;
+        return result;
+    }
+
+    QString language() const
+    {
+        return "NoOp";
+    }
+};
+
+
+/**
+ * @brief InterpreterPlugin providing NoOpInterpreters.
+ */
+class NoOpInterpreterPlugin :
+        public QObject,
+        public ScriptEmbedderNS::InterpreterPlugin
+{
+    Q_OBJECT
+    Q_INTERFACES(ScriptEmbedderNS::InterpreterPlugin)
+    Q_PLUGIN_METADATA(IID INTERPRETER_PLUGIN_IID)
+
+public:
+
+    NoOpInterpreterPlugin() : QObject(), ScriptEmbedderNS::InterpreterPlugin() {}
+
+    virtual ~NoOpInterpreterPlugin() {}
+
+    QString language() const
+    {
+        return "NoOp";
+    }
+
+    ScriptEmbedderNS::ScriptInterpreter* getInstance() const
+    {
+        return new NoOpInterpreter();
+    }
+};
+
+
+#endif // NOOPINTERPRETERPLUGIN_HH
@@ -0,0 +1,11 @@
+QT += core
+QT -= gui
+CONFIG += c++11
+
+TEMPLATE = lib
+TARGET = SpinInterpreterPlugin
+
+INCLUDEPATH += ../../../ScriptEmbedder/include
+
+HEADERS += \
+    spininterpreterplugin.hh
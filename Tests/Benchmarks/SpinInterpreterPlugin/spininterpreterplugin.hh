@@ -0,0 +1,93 @@
+/**
+ * @file
+ * @brief Interpreter plugin that busy-waits for a given time, for measuring
+ * ScriptEmbedder with realistic script durations.
+ * @author Perttu Paarlahti 2016.
+ */
+
+#ifndef SPININTERPRETERPLUGIN_HH
+#define SPININTERPRETERPLUGIN_HH
+
+#include <QElapsedTimer>
+#include "interpreterplugin.hh"
+
+
+/**
+ * @brief ScriptInterpreter that spins for the number of microseconds given
+ * as the script source, e.g. a script file containing "100" runs for 100 µs.
+ * Spinning keeps the thread busy like a real script would. Instances share
+ * no state, so they may run concurrently.
+ */
+class SpinInterpreter : public ScriptEmbedderNS::ScriptInterpreter
+{
+public:
+
+    SpinInterpreter() : ScriptEmbedderNS::ScriptInterpreter() {}
+
+    virtual ~SpinInterpreter() {}
+
+    void SetScriptAPI(std::shared_ptr<ScriptEmbedderNS::ScriptAPI> api)
+    {
+        Q_UNUSED(api);
+    }
+
+    ScriptRunResult runScript(const QString& script, const QStringList& params)
+    {
+        Q_UNUSED(params);
+        ScriptRunResult result;
+        bool ok = false;
+        qint64 delay = script.trimmed().toLongLong(&ok) * 1000;
+        if (!ok || delay < 0) {
+            result.result = FAILURE;
+            result.returnValue = 0;
+            result.errorString = "Script must be a non-negative number of microseconds.";
+            return result;
+        }
+
+        QElapsedTimer timer;
+        timer.start();
+        while (timer.nsecsElapsed() < delay) {
+        }
+
+        result.result = SUCCESS;
+        result.returnValue = 0;
+        return result;
+    }
+
+    QString language() const
+    {
+        return "Spin";
+    }
+};
+
+
+/**
+ * @brief InterpreterPlugin providing SpinInterpreters.
+ */
+class SpinInterpreterPlugin :
+        public QObject,
+        public ScriptEmbedderNS::InterpreterPlugin
+{
+    Q_OBJECT
+    Q_INTERFACES(ScriptEmbedderNS::InterpreterPlugin)
+    Q_PLUGIN_METADATA(IID INTERPRETER_PLUGIN_IID)
+
+public:
+
+    SpinInterpreterPlugin() : QObject(), ScriptEmbedderNS::InterpreterPlugin() {}
+
+    virtual ~SpinInterpreterPlugin() {}
+
+    QString language() const
+    {
+        return "Spin";
+    }
+
+    ScriptEmbedderNS::ScriptInterpreter* getInstance() const
+    {
+        return new SpinInterpreter();
+    }
+};
+
+
+#endif // SPININTERPRETERPLUGIN_HH
@@ -0,0 +1,23 @@
+#-------------------------------------------------
+#
+# Project created by QtCreator 2016-06-28T19:42:17
+#
+#-------------------------------------------------
+
+QT       += testlib
+
+QT       -= gui
+
+TARGET = tst_configurationfiletest
+CONFIG   += console c++11
+CONFIG   -= app_bundle
+
+TEMPLATE = app
+
+INCLUDEPATH += ../../ScriptEmbedder/include
+
+SOURCES += tst_configurationfiletest.cc \
+           ../../ScriptEmbedder/src/configurationfile.cc \
+           ../../ScriptEmbedder/src/configuration.cc
+
+DEFINES += SRCDIR=\\\"$$PWD/\\\"
@@ -0,0 +1,291 @@
+/**
+ * @file
+ * @brief Unit tests for the ConfigurationFile class.
+ * @author Perttu Paarlahti 2016.
+ */
+
+#include <QString>
+#include <QtTest>
+#include <QTemporaryDir>
+#include "configurationfile.hh"
+
+
+/**
+ * @brief Unit tests for the ConfigurationFile class.
+ */
+class ConfigurationFileTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    ConfigurationFileTest();
+
+private Q_SLOTS:
+
+    /**
+     * @brief Test that saved configuration is read back unchanged.
+     */
+    void binaryRoundTripTest();
+
+    /**
+     * @brief Test accessing entries of the mapped file without
+     * converting it into Configuration.
+     */
+    void mappedAccessTest();
+
+    /**
+     * @brief Test that exported JSON is imported back unchanged.
+     */
+    void jsonRoundTripTest();
+
+    /**
+     * @brief Test importing invalid JSON documents.
+     */
+    void invalidJsonTest();
+
+    /**
+     * @brief Test opening missing, invalid and corrupted binary files.
+     */
+    void invalidFileTest();
+
+    /**
+     * @brief Test that failed saves and imports do not close the open file.
+     */
+    void failureKeepsFileOpenTest();
+
+
+private:
+
+    ScriptEmbedderNS::Configuration createConfiguration() const;
+};
+
+
+ConfigurationFileTest::ConfigurationFileTest()
+{
+}
+
+
+void ConfigurationFileTest::binaryRoundTripTest()
+{
+    using namespace ScriptEmbedderNS;
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    QString path = dir.path() + "/conf.bin";
+    Configuration conf = this->createConfiguration();
+
+    ConfigurationFile file;
+    QVERIFY(file.save(conf, path));
+    QVERIFY(file.errorString().isEmpty());
+    QVERIFY(!file.isOpen());
+    QVERIFY(file.open(path));
+    QVERIFY(file.isOpen());
+
+    Configuration loaded = file.toConfiguration(conf.scriptAPI());
+    QVERIFY(loaded.scriptAPI() == conf.scriptAPI());
+    QVERIFY(loaded.interpreters() == conf.interpreters());
+    QVERIFY(loaded.scripts() == conf.scripts());
+
+    file.close();
+    QVERIFY(!file.isOpen());
+
+    // Empty configuration.
+    QVERIFY(file.save(Configuration(), path));
+    QVERIFY(file.open(path));
+    QCOMPARE(file.interpreterCount(), 0u);
+    QCOMPARE(file.scriptCount(), 0u);
+}
+
+
+void ConfigurationFileTest::mappedAccessTest()
+{
+    using namespace ScriptEmbedderNS;
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    QString path = dir.path() + "/conf.bin";
+    Configuration conf = this->createConfiguration();
+
+    ConfigurationFile file;
+    QVERIFY(file.save(conf, path));
+    QVERIFY(file.open(path));
+    QCOMPARE(file.interpreterCount(), unsigned(conf.interpreters().size()));
+    QCOMPARE(file.scriptCount(), unsigned(conf.scripts().size()));
+
+    unsigned index = 0;
+    for (auto it = conf.interpreters().begin(); it != conf.interpreters().end(); ++it) {
+        QVERIFY(file.interpreter(index++) == it->second);
+    }
+    index = 0;
+    for (auto it = conf.scripts().begin(); it != conf.scripts().end(); ++it) {
+        QVERIFY(file.script(index++) == it->second);
+
+        ScriptEntry found;
+        QVERIFY(file.findScript(it->first, found));
+        QVERIFY(found == it->second);
+    }
+
+    ScriptEntry missing;
+    QVERIFY(!file.findScript(4u, missing));
+    QVERIFY(!file.findScript(1000000u, missing));
+    QVERIFY(missing == ScriptEntry());
+}
+
+
+void ConfigurationFileTest::jsonRoundTripTest()
+{
+    using namespace ScriptEmbedderNS;
+    Configuration conf = this->createConfiguration();
+    QByteArray json = ConfigurationFile::toJson(conf);
+
+    ConfigurationFile file;
+    Configuration imported;
+    QVERIFY(file.fromJson(json, imported));
+    QVERIFY(file.errorString().isEmpty());
+    QVERIFY(imported.interpreters() == conf.interpreters());
+    QVERIFY(imported.scripts() == conf.scripts());
+
+    // Optional fields.
+    Configuration minimal;
+    QVERIFY(file.fromJson("{\"scripts\": [{\"id\": 7, \"path\": \"a.js\", "
+                          "\"language\": \"JavaScript\"}]}", minimal));
+    QVERIFY(minimal.interpreters().empty());
+    QCOMPARE(minimal.scripts().size(), std::size_t(1));
+    QVERIFY(minimal.scripts().at(7u) == ScriptEntry(7u, "a.js", "JavaScript"));
+
+    // Inline source instead of path.
+    QVERIFY(file.fromJson("{\"scripts\": [{\"id\": 8, \"source\": \"x = 1\", "
+                          "\"language\": \"Python\"}]}", minimal));
+    QVERIFY(minimal.scripts().at(8u) == ScriptEntry::fromSource(8u, "x = 1", "Python"));
+}
+
+
+void ConfigurationFileTest::invalidJsonTest()
+{
+    using namespace ScriptEmbedderNS;
+    ConfigurationFile file;
+    Configuration conf = this->createConfiguration();
+    Configuration original = conf;
+
+    QList<QByteArray> documents;
+    documents << "{\"scripts\": ["
+              << "[1, 2, 3]"
+              << "{\"interpreters\": [{\"language\": \"JavaScript\"}]}"
+              << "{\"scripts\": [{\"id\": -1, \"path\": \"a.js\", \"language\": \"JS\"}]}"
+              << "{\"scripts\": [{\"id\": 1.5, \"path\": \"a.js\", \"language\": \"JS\"}]}"
+              << "{\"scripts\": [{\"id\": 1, \"language\": \"JS\"}]}"
+              << "{\"scripts\": [{\"id\": 1, \"source\": \"\", \"language\": \"JS\"}]}"
+              << "{\"scripts\": [{\"id\": 1, \"path\": \"a.js\", \"language\": \"JS\", "
+                 "\"storage\": \"zip\"}]}"
+              << "{\"scripts\": [{\"id\": 1, \"path\": \"a.js\", \"language\": \"JS\", "
+                 "\"checkInterval\": 0.5}]}"
+              // Valid entry before an invalid one must not be imported.
+              << "{\"scripts\": [{\"id\": 100, \"path\": \"a.js\", \"language\": \"JS\"},"
+                 "{\"id\": 101, \"path\": \"b.js\", \"language\": \"JS\", \"priority\": \"x\"}]}";
+
+    foreach (const QByteArray& json, documents) {
+        QVERIFY2(!file.fromJson(json, conf), json.constData());
+        QVERIFY(!file.errorString().isEmpty());
+        QVERIFY(conf.interpreters() == original.interpreters());
+        QVERIFY(conf.scripts() == original.scripts());
+    }
+
+    // Error names the invalid field.
+    QVERIFY(!file.fromJson("{\"scripts\": [{\"id\": 1, \"path\": \"a.js\", "
+                           "\"language\": \"JS\", \"priority\": -1}]}", conf));
+    QVERIFY(file.errorString().contains("'priority'"));
+    QVERIFY(!file.fromJson("{\"scripts\": [{\"id\": 1, \"path\": \"a.js\", "
+                           "\"language\": \"JS\", \"checkInterval\": \"x\"}]}", conf));
+    QVERIFY(file.errorString().contains("'checkInterval'"));
+}
+
+
+void ConfigurationFileTest::invalidFileTest()
+{
+    using namespace ScriptEmbedderNS;
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    QString path = dir.path() + "/conf.bin";
+
+    ConfigurationFile file;
+    QVERIFY(!file.open(dir.path() + "/missing.bin"));
+    QVERIFY(!file.isOpen());
+    QVERIFY(!file.errorString().isEmpty());
+
+    QVERIFY(file.save(this->createConfiguration(), path));
+    QFile f(path);
+    QVERIFY(f.open(QFile::ReadOnly));
+    QByteArray valid = f.readAll();
+    f.close();
+
+    QList<QByteArray> corrupted;
+    // Too short for a header.
+    corrupted << valid.left(10);
+    // Wrong magic.
+    corrupted << QByteArray(valid).replace(0, 4, "XXXX");
+    // Unsupported version.
+    corrupted << QByteArray(valid).replace(4, 1, "\x09");
+    // Script count larger than the file.
+    corrupted << QByteArray(valid).replace(12, 4, QByteArray("\xff\xff\x00\x00", 4));
+    // String data truncated.
+    corrupted << valid.left(valid.size() - 1);
+
+    foreach (const QByteArray& data, corrupted) {
+        QVERIFY(f.open(QFile::WriteOnly | QFile::Truncate));
+        f.write(data);
+        f.close();
+        QVERIFY(!file.open(path));
+        QVERIFY(!file.isOpen());
+        QVERIFY(!file.errorString().isEmpty());
+    }
+}
+
+
+void ConfigurationFileTest::failureKeepsFileOpenTest()
+{
+    using namespace ScriptEmbedderNS;
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    QString path = dir.path() + "/conf.bin";
+    Configuration conf = this->createConfiguration();
+
+    ConfigurationFile file;
+    QVERIFY(file.save(conf, path));
+    QVERIFY(file.open(path));
+
+    Configuration imported;
+    QVERIFY(!file.fromJson("[", imported));
+    QVERIFY(!file.errorString().isEmpty());
+    QVERIFY(file.isOpen());
+
+    QVERIFY(!file.save(conf, dir.path() + "/missing/conf.bin"));
+    QVERIFY(!file.errorString().isEmpty());
+    QVERIFY(file.isOpen());
+    QCOMPARE(file.scriptCount(), unsigned(conf.scripts().size()));
+}
+
+
+ScriptEmbedderNS::Configuration ConfigurationFileTest::createConfiguration() const
+{
+    using namespace ScriptEmbedderNS;
+    Configuration conf;
+    conf.setScriptAPI(std::shared_ptr<ScriptAPI>(new ScriptAPI()));
+    conf.addInterpreter(InterpreterEntry("JavaScript", "plugins/libJSPlugin.so"));
+    conf.addInterpreter(InterpreterEntry("Python", "plugins/libPythonPlugin.so"));
+    conf.addScript(ScriptEntry(5u, "scripts/a.js", "JavaScript"));
+    conf.addScript(ScriptEntry(1u, "scripts/b.py", "Python", true, 3u, "main"));
+    conf.addScript(ScriptEntry(300000u, "scripts/a.js", "JavaScript", true, 0u,
+                               QString(), ScriptEntry::MAPPED));
+    conf.addScript(ScriptEntry(2u, QString::fromUtf8("scripts/\xc3\xa4.js"), "JavaScript",
+                               false, 0u, "run"));
+    conf.addScript(ScriptEntry::fromSource(7u, "print('inline');", "JavaScript"));
+    ScriptEntry cached(9u, "scripts/c.js", "JavaScript");
+    cached.checkInterval = 500;
+    conf.addScript(cached);
+    conf.addScript(ScriptEntry::fromSource(8u, "def f():\n    pass\n", "Python", 1u, "f",
+                                           ScriptEntry::COMPRESSED));
+    return conf;
+}
+
+
+QTEST_APPLESS_MAIN(ConfigurationFileTest)
+
+#include "tst_configurationfiletest.moc"
@@ -83,6 +83,16 @@ private Q_SLOTS:
      */
     void apiSetterGetterTest();
 
+    /**
+     * @brief Test that validate reports all errors.
+     */
+    void validateTest();
+
+    /**
+     * @brief Test that copies share data until modified.
+     */
+    void copyOnWriteTest();
+
     /**
      * @brief Test the addInterpreter, removeInterpreter, getInterpreter,
      * interpreters and hasInterpreter methods.
@@ -109,6 +119,9 @@ void ConfigurationTest::scriptEntryConstructorTest()
     QCOMPARE(entry1.scriptLanguage, QString());
     QCOMPARE(entry1.readToRAM, false);
     QCOMPARE(entry1.priority, 0u);
+    QCOMPARE(entry1.entryPoint, QString());
+    QCOMPARE(entry1.storage, ScriptEmbedderNS::ScriptEntry::COPY);
+    QCOMPARE(entry1.checkInterval, -1);
 
     ScriptEmbedderNS::ScriptEntry entry2(10u, "testScript.py", "Python", true, 1u);
     QCOMPARE(entry2.id, 10u);
@@ -123,6 +136,38 @@ void ConfigurationTest::scriptEntryConstructorTest()
     QCOMPARE(entry3.scriptLanguage, QString("Python"));
     QCOMPARE(entry3.readToRAM, false);
     QCOMPARE(entry3.priority, 0u);
+    QCOMPARE(entry3.entryPoint, QString());
+
+    ScriptEmbedderNS::ScriptEntry entry4(10u, "testScript.py", "Python", true, 2u, "main");
+    QCOMPARE(entry4.id, 10u);
+    QCOMPARE(entry4.readToRAM, true);
+    QCOMPARE(entry4.priority, 2u);
+    QCOMPARE(entry4.entryPoint, QString("main"));
+    QCOMPARE(entry4.storage, ScriptEmbedderNS::ScriptEntry::COPY);
+
+    ScriptEmbedderNS::ScriptEntry entry5(10u, "testScript.py", "Python", true, 0u, QString(),
+                                         ScriptEmbedderNS::ScriptEntry::MAPPED);
+    QCOMPARE(entry5.storage, ScriptEmbedderNS::ScriptEntry::MAPPED);
+    QVERIFY(!entry5.isInline());
+
+    ScriptEmbedderNS::ScriptEntry entry6 =
+            ScriptEmbedderNS::ScriptEntry::fromSource(11u, "print(1)", "Python", 3u);
+    QCOMPARE(entry6.id, 11u);
+    QCOMPARE(entry6.scriptPath, QString());
+    QCOMPARE(entry6.source, QString("print(1)"));
+    QCOMPARE(entry6.scriptLanguage, QString("Python"));
+    QCOMPARE(entry6.readToRAM, true);
+    QCOMPARE(entry6.priority, 3u);
+    QCOMPARE(entry6.storage, ScriptEmbedderNS::ScriptEntry::COPY);
+    QVERIFY(entry6.isInline());
+    QVERIFY(!entry6.isCached());
+
+    ScriptEmbedderNS::ScriptEntry entry7(12u, "testScript.py", "Python");
+    QVERIFY(!entry7.isCached());
+    entry7.checkInterval = 0;
+    QVERIFY(entry7.isCached());
+    entry7.readToRAM = true;
+    QVERIFY(!entry7.isCached());
 }
 
 
@@ -199,6 +244,7 @@ void ConfigurationTest::scriptComparisonTest()
         QCOMPARE(entry1.scriptLanguage, entry2.scriptLanguage);
         QCOMPARE(entry1.readToRAM, entry2.readToRAM);
         QCOMPARE(entry1.priority, entry2.priority);
+        QCOMPARE(entry1.entryPoint, entry2.entryPoint);
     }
 }
 
@@ -240,6 +286,28 @@ void ConfigurationTest::scriptComparisonTest_data()
             << ScriptEntry {0u, "scriptPath1", "Python", false, 1u}
             << false;
 
+    QTest::newRow("different entry point")
+            << ScriptEntry {0u, "scriptPath1", "Python", false, 0u, "main"}
+            << ScriptEntry {0u, "scriptPath1", "Python", false, 0u}
+            << false;
+
+    QTest::newRow("different storage")
+            << ScriptEntry {0u, "scriptPath1", "Python", true, 0u, QString(), ScriptEntry::MAPPED}
+            << ScriptEntry {0u, "scriptPath1", "Python", true, 0u}
+            << false;
+
+    QTest::newRow("different source")
+            << ScriptEntry::fromSource(0u, "source1", "Python")
+            << ScriptEntry::fromSource(0u, "source2", "Python")
+            << false;
+
+    ScriptEntry cached {0u, "scriptPath1", "Python", false, 0u};
+    cached.checkInterval = 100;
+    QTest::newRow("different check interval")
+            << cached
+            << ScriptEntry {0u, "scriptPath1", "Python", false, 0u}
+            << false;
+
     QTest::newRow("all different")
             << ScriptEntry {0u, "scriptPath1", "Python", false, 0u}
             << ScriptEntry {1u, "scriptPath2", "JavaScript", true, 1u}
@@ -302,6 +370,17 @@ void ConfigurationTest::constructorAndIsValidTest_data()
             << true
             << QString();
 
+    QTest::newRow("inline script")
+            << std::shared_ptr<ScriptAPI>(new ScriptAPI())
+            << InterpreterMap {
+                    {"Python", InterpreterEntry{"Python", TEST_PATH+"notAnActualPlugin1"+LIB_POSTFIX}}
+                }
+            << ScriptMap {
+                    {0u, ScriptEntry::fromSource(0u, "print(1)", "Python")}
+                }
+            << true
+            << QString();
+
     QTest::newRow("scriptfile not found")
             << std::shared_ptr<ScriptAPI>(new ScriptAPI())
             << InterpreterMap {
@@ -359,6 +438,81 @@ void ConfigurationTest::constructorAndIsValidTest_data()
 }
 
 
+void ConfigurationTest::validateTest()
+{
+    using namespace ScriptEmbedderNS;
+    const QString TEST_PATH = "../../../ScriptEmbedder/Tests/ConfigurationTest/testfiles/";
+    typedef ValidationReport::Error Error;
+
+    // Empty configuration.
+    ValidationReport report = Configuration().validate();
+    QVERIFY(!report.isValid());
+    QVERIFY(report.errors.size() == 2);
+    QVERIFY(report.errors.at(0).kind == Error::NO_SCRIPT_API);
+    QVERIFY(report.errors.at(1).kind == Error::NO_INTERPRETERS);
+    QCOMPARE(report.errorString(), QString("ScriptAPI has not been set.\n"
+                                           "At liest one interpreter has to be set."));
+
+    // Several invalid scripts and an invalid plugin.
+    Configuration c;
+    c.setScriptAPI(std::shared_ptr<ScriptAPI>(new ScriptAPI()));
+    c.addInterpreter(InterpreterEntry("Python", TEST_PATH+"notAnActualPlugin1.txt"));
+    c.addScript(ScriptEntry(0u, TEST_PATH+"notAPythonScript1.py", "Python"));
+    c.addScript(ScriptEntry(1u, TEST_PATH+"does_not_exist.py", "Python"));
+    c.addScript(ScriptEntry(2u, TEST_PATH+"does_not_exist.py", "Lua"));
+    report = c.validate();
+    QVERIFY(report.errors.size() == 4);
+    QVERIFY(report.errors.at(0).kind == Error::INVALID_SCRIPT_PATH);
+    QCOMPARE(report.errors.at(0).scriptId, 1u);
+    QVERIFY(report.errors.at(1).kind == Error::INVALID_SCRIPT_PATH);
+    QCOMPARE(report.errors.at(1).scriptId, 2u);
+    QVERIFY(report.errors.at(2).kind == Error::NO_SUITABLE_INTERPRETER);
+    QCOMPARE(report.errors.at(2).scriptId, 2u);
+    QVERIFY(report.errors.at(3).kind == Error::INVALID_PLUGIN_PATH);
+    QCOMPARE(c.errorString(), report.errors.at(0).message);
+
+    // Many scripts sharing files are checked in parallel.
+    c.addInterpreter(InterpreterEntry("Python", TEST_PATH+"notAnActualPlugin1.so"));
+    c.removeScript(1u);
+    c.removeScript(2u);
+    for (unsigned i = 0; i < 5000; ++i) {
+        c.addScript(ScriptEntry(i, TEST_PATH+QString("file%1.py").arg(i % 2000), "Python"));
+    }
+    c.addScript(ScriptEntry(5000u, TEST_PATH+"notAPythonScript1.py", "Python"));
+    report = c.validate();
+    QVERIFY(report.errors.size() == 5000);
+    QCOMPARE(report.errors.at(4999).scriptId, 4999u);
+}
+
+
+void ConfigurationTest::copyOnWriteTest()
+{
+    using namespace ScriptEmbedderNS;
+    Configuration original;
+    original.addInterpreter(InterpreterEntry("Python", "plugin.so"));
+    original.addScript(ScriptEntry(0u, "path1", "Python"));
+
+    // Copies share the same maps.
+    Configuration copy(original);
+    Configuration assigned;
+    assigned = original;
+    QVERIFY(&copy.scripts() == &original.scripts());
+    QVERIFY(&assigned.interpreters() == &original.interpreters());
+
+    // Modifying a copy does not affect the others.
+    copy.addScript(ScriptEntry(1u, "path2", "Python"));
+    QVERIFY(&copy.scripts() != &original.scripts());
+    QCOMPARE(copy.scripts().size(), ScriptMap::size_type(2));
+    QCOMPARE(original.scripts().size(), ScriptMap::size_type(1));
+    QCOMPARE(assigned.scripts().size(), ScriptMap::size_type(1));
+
+    assigned.removeInterpreter("Python");
+    QVERIFY(assigned.interpreters().empty());
+    QVERIFY(original.hasInterpreter("Python"));
+    QVERIFY(copy.hasInterpreter("Python"));
+}
+
+
 void ConfigurationTest::apiSetterGetterTest()
 {
     using namespace ScriptEmbedderNS;
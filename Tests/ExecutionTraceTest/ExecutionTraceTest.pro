@@ -0,0 +1,22 @@
+#-------------------------------------------------
+#
+# Project created by QtCreator 2016-06-26T16:10:44
+#
+#-------------------------------------------------
+
+QT       += testlib
+
+QT       -= gui
+
+TARGET = tst_executiontracetest
+CONFIG   += console c++11
+CONFIG   -= app_bundle
+
+TEMPLATE = app
+
+INCLUDEPATH += ../../ScriptEmbedder/include
+
+SOURCES += tst_executiontracetest.cc \
+           ../../ScriptEmbedder/src/executiontrace.cc
+
+DEFINES += SRCDIR=\\\"$$PWD/\\\"
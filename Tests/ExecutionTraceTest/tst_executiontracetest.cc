@@ -0,0 +1,157 @@
+/**
+ * @file
+ * @brief Unit tests for the ExecutionTraceWriter and ExecutionTraceReader classes.
+ * @author Perttu Paarlahti 2016.
+ */
+
+#include <QString>
+#include <QtTest>
+#include <QTemporaryDir>
+#include "executiontrace.hh"
+
+
+/**
+ * @brief Unit tests for the ExecutionTraceWriter and ExecutionTraceReader classes.
+ */
+class ExecutionTraceTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    ExecutionTraceTest();
+
+private Q_SLOTS:
+
+    /**
+     * @brief Test that written events are read back unchanged.
+     */
+    void roundTripTest();
+
+    /**
+     * @brief Test writing and reading more events than fit into one block.
+     */
+    void largeTraceTest();
+
+    /**
+     * @brief Test reading invalid and truncated files.
+     */
+    void invalidFileTest();
+};
+
+
+ExecutionTraceTest::ExecutionTraceTest()
+{
+}
+
+
+void ExecutionTraceTest::roundTripTest()
+{
+    using namespace ScriptEmbedderNS;
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    QString path = dir.path() + "/trace.bin";
+
+    std::vector<TraceEvent> events(3);
+    events[0].timestamp = 100;
+    events[0].scriptId = 1u;
+    events[1].timestamp = 100;
+    events[1].scriptId = 300000u;
+    events[1].params = QStringList{"a", "", QString::fromUtf8("\xc3\xa4\xc3\xb6")};
+    events[2].timestamp = 5000000000ll;
+    events[2].scriptId = 2u;
+    events[2].params = QStringList{"param"};
+
+    ExecutionTraceWriter writer;
+    QVERIFY(!writer.isOpen());
+    QVERIFY(writer.open(path));
+    for (auto it = events.begin(); it != events.end(); ++it) {
+        QVERIFY(writer.write(*it));
+    }
+    QVERIFY(writer.close());
+
+    ExecutionTraceReader reader;
+    QVERIFY(reader.open(path));
+    TraceEvent event;
+    for (auto it = events.begin(); it != events.end(); ++it) {
+        QVERIFY(reader.next(event));
+        QCOMPARE(event.timestamp, it->timestamp);
+        QCOMPARE(event.scriptId, it->scriptId);
+        QCOMPARE(event.params, it->params);
+    }
+    QVERIFY(!reader.next(event));
+    QVERIFY(reader.errorString().isEmpty());
+}
+
+
+void ExecutionTraceTest::largeTraceTest()
+{
+    using namespace ScriptEmbedderNS;
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    QString path = dir.path() + "/trace.bin";
+    const unsigned EVENTS = 20000;
+
+    {
+        ExecutionTraceWriter writer;
+        QVERIFY(writer.open(path));
+        TraceEvent event;
+        event.params = QStringList{"some parameter"};
+        for (unsigned i = 0; i < EVENTS; ++i) {
+            event.timestamp = i * 1000;
+            event.scriptId = i;
+            QVERIFY(writer.write(event));
+        }
+        // Parameter larger than a read block.
+        event.timestamp = EVENTS * 1000;
+        event.scriptId = EVENTS;
+        event.params = QStringList{QString(200000, 'x')};
+        QVERIFY(writer.write(event));
+        // Destructor writes the rest.
+    }
+
+    ExecutionTraceReader reader;
+    QVERIFY(reader.open(path));
+    TraceEvent event;
+    unsigned count = 0;
+    while (reader.next(event)) {
+        QCOMPARE(event.scriptId, count);
+        QCOMPARE(event.timestamp, qint64(count) * 1000);
+        ++count;
+    }
+    QCOMPARE(count, EVENTS + 1);
+    QCOMPARE(event.params.at(0).size(), 200000);
+    QVERIFY(reader.errorString().isEmpty());
+}
+
+
+void ExecutionTraceTest::invalidFileTest()
+{
+    using namespace ScriptEmbedderNS;
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    ExecutionTraceReader reader;
+    QVERIFY(!reader.open(dir.path() + "/missing.bin"));
+    QVERIFY(!reader.errorString().isEmpty());
+
+    // Wrong magic.
+    QFile f(dir.path() + "/invalid.bin");
+    QVERIFY(f.open(QFile::WriteOnly));
+    f.write("XXXX\x01");
+    f.close();
+    QVERIFY(!reader.open(f.fileName()));
+    QVERIFY(!reader.errorString().isEmpty());
+
+    // Parameter longer than the rest of the file.
+    QVERIFY(f.open(QFile::WriteOnly | QFile::Truncate));
+    f.write(QByteArray("SETR\x01\x00\x01\x01\x10" "abc", 12));
+    f.close();
+    QVERIFY(reader.open(f.fileName()));
+    TraceEvent event;
+    QVERIFY(!reader.next(event));
+    QVERIFY(!reader.errorString().isEmpty());
+}
+
+
+QTEST_APPLESS_MAIN(ExecutionTraceTest)
+
+#include "tst_executiontracetest.moc"
@@ -0,0 +1,22 @@
+#-------------------------------------------------
+#
+# Project created by QtCreator 2016-06-19T12:40:12
+#
+#-------------------------------------------------
+
+QT       += testlib
+
+QT       -= gui
+
+TARGET = tst_executiontracertest
+CONFIG   += console c++11
+CONFIG   -= app_bundle
+
+TEMPLATE = app
+
+INCLUDEPATH += ../../ScriptEmbedder/include
+
+SOURCES += tst_executiontracertest.cc \
+           ../../ScriptEmbedder/src/executiontracer.cc
+
+DEFINES += SRCDIR=\\\"$$PWD/\\\"
@@ -0,0 +1,164 @@
+/**
+ * @file
+ * @brief Unit tests for the ExecutionTracer class.
+ * @author Perttu Paarlahti 2016.
+ */
+
+#include <QString>
+#include <QtTest>
+#include <QTemporaryDir>
+#include <thread>
+#include "executiontracer.hh"
+
+
+/**
+ * @brief Unit tests for the ExecutionTracer class.
+ */
+class ExecutionTracerTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    ExecutionTracerTest();
+
+private Q_SLOTS:
+
+    /**
+     * @brief Test recording spans.
+     */
+    void recordTest();
+
+    /**
+     * @brief Test that oldest spans are overwritten when buffer is full.
+     */
+    void overflowTest();
+
+    /**
+     * @brief Test that spans from different threads are told apart.
+     */
+    void threadTest();
+
+    /**
+     * @brief Test exporting spans as trace-event JSON.
+     */
+    void jsonTest();
+
+    /**
+     * @brief Test that spans are written to output path on destruction.
+     */
+    void destructorTest();
+};
+
+
+ExecutionTracerTest::ExecutionTracerTest()
+{
+}
+
+
+void ExecutionTracerTest::recordTest()
+{
+    using namespace ScriptEmbedderNS;
+    ExecutionTracer tracer(8u);
+    QVERIFY(tracer.spans().empty());
+    QVERIFY(tracer.now() >= 0);
+
+    tracer.record(ExecutionTracer::LOAD, 1u, nullptr, "JavaScript", 10, 20);
+    tracer.record(ExecutionTracer::RUN, 1u, nullptr, "JavaScript", 20, 50);
+    std::vector<ExecutionTracer::Span> spans = tracer.spans();
+    QVERIFY(spans.size() == 2);
+    QVERIFY(spans.at(0).phase == ExecutionTracer::LOAD);
+    QCOMPARE(spans.at(0).scriptId, 1u);
+    QCOMPARE(spans.at(0).language, QString("JavaScript"));
+    QCOMPARE(spans.at(0).begin, qint64(10));
+    QCOMPARE(spans.at(0).end, qint64(20));
+    QVERIFY(spans.at(1).phase == ExecutionTracer::RUN);
+    QCOMPARE(tracer.dropped(), 0ull);
+
+    tracer.clear();
+    QVERIFY(tracer.spans().empty());
+}
+
+
+void ExecutionTracerTest::overflowTest()
+{
+    using namespace ScriptEmbedderNS;
+    ExecutionTracer tracer(2u);
+    tracer.record(ExecutionTracer::ENQUEUE, 1u, nullptr, "Lua", 0, 1);
+    tracer.record(ExecutionTracer::ENQUEUE, 2u, nullptr, "Lua", 1, 2);
+    tracer.record(ExecutionTracer::ENQUEUE, 3u, nullptr, "Lua", 2, 3);
+
+    std::vector<ExecutionTracer::Span> spans = tracer.spans();
+    QVERIFY(spans.size() == 2);
+    QCOMPARE(spans.at(0).scriptId, 2u);
+    QCOMPARE(spans.at(1).scriptId, 3u);
+    QCOMPARE(tracer.dropped(), 1ull);
+}
+
+
+void ExecutionTracerTest::threadTest()
+{
+    using namespace ScriptEmbedderNS;
+    ExecutionTracer tracer(8u);
+    tracer.record(ExecutionTracer::RUN, 1u, nullptr, "Lua", 0, 1);
+    std::thread other([&tracer]() {
+        tracer.record(ExecutionTracer::RUN, 2u, nullptr, "Lua", 0, 1);
+    });
+    other.join();
+
+    std::vector<ExecutionTracer::Span> spans = tracer.spans();
+    QVERIFY(spans.size() == 2);
+    QVERIFY(spans.at(0).thread != spans.at(1).thread);
+}
+
+
+void ExecutionTracerTest::jsonTest()
+{
+    using namespace ScriptEmbedderNS;
+    ExecutionTracer tracer(8u);
+    tracer.record(ExecutionTracer::COMPILE, 4u, nullptr, "Lua", 1000, 3500);
+
+    QJsonParseError error;
+    QJsonDocument doc = QJsonDocument::fromJson(tracer.toJson(), &error);
+    QCOMPARE(error.error, QJsonParseError::NoError);
+    QJsonArray events = doc.object().value("traceEvents").toArray();
+    QCOMPARE(events.size(), 1);
+    QJsonObject event = events.at(0).toObject();
+    QCOMPARE(event.value("name").toString(), QString("compile"));
+    QCOMPARE(event.value("cat").toString(), QString("Lua"));
+    QCOMPARE(event.value("ph").toString(), QString("X"));
+    QCOMPARE(event.value("ts").toDouble(), 1.0);
+    QCOMPARE(event.value("dur").toDouble(), 2.5);
+    QCOMPARE(event.value("args").toObject().value("script").toInt(), 4);
+
+    // Special characters in language names are escaped.
+    QString language = QString("a\"b\\c\nd") + QChar(0x01) + QChar(0x1f);
+    tracer.record(ExecutionTracer::RUN, 5u, nullptr, language, 4000, 5000);
+    doc = QJsonDocument::fromJson(tracer.toJson(), &error);
+    QCOMPARE(error.error, QJsonParseError::NoError);
+    events = doc.object().value("traceEvents").toArray();
+    QCOMPARE(events.size(), 2);
+    QCOMPARE(events.at(1).toObject().value("cat").toString(), language);
+}
+
+
+void ExecutionTracerTest::destructorTest()
+{
+    using namespace ScriptEmbedderNS;
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    QString path = dir.path() + "/trace.json";
+    {
+        ExecutionTracer tracer(8u, path);
+        tracer.record(ExecutionTracer::LOG, 1u, nullptr, "Lua", 0, 1);
+    }
+
+    QFile f(path);
+    QVERIFY(f.open(QFile::ReadOnly));
+    QJsonDocument doc = QJsonDocument::fromJson(f.readAll());
+    QCOMPARE(doc.object().value("traceEvents").toArray().size(), 1);
+}
+
+
+QTEST_APPLESS_MAIN(ExecutionTracerTest)
+
+#include "tst_executiontracertest.moc"
@@ -0,0 +1,24 @@
+#-------------------------------------------------
+#
+# Project created by QtCreator 2016-07-03T16:22:10
+#
+#-------------------------------------------------
+
+QT       += testlib
+
+QT       -= gui
+
+TARGET = tst_filestamptest
+CONFIG   += console c++11
+CONFIG   -= app_bundle
+
+TEMPLATE = app
+
+INCLUDEPATH += \
+    ../../ScriptEmbedder/include \
+    ../../ScriptEmbedder/src
+
+SOURCES += tst_filestamptest.cc \
+           ../../ScriptEmbedder/src/filestamp.cc
+
+DEFINES += SRCDIR=\\\"$$PWD/\\\"
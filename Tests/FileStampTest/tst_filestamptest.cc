@@ -0,0 +1,105 @@
+/**
+ * @file
+ * @brief Unit tests for the FileStamp class.
+ * @author Perttu Paarlahti 2016.
+ */
+
+#include <QString>
+#include <QtTest>
+#include <QTemporaryDir>
+#include "filestamp.hh"
+
+
+/**
+ * @brief Unit tests for the FileStamp class.
+ */
+class FileStampTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    FileStampTest();
+
+private Q_SLOTS:
+
+    /**
+     * @brief Test stamps of missing and unchanged files.
+     */
+    void readTest();
+
+    /**
+     * @brief Test that modified and replaced files are detected.
+     */
+    void changeTest();
+
+
+private:
+
+    bool write(const QString& path, const QByteArray& contents) const;
+};
+
+
+FileStampTest::FileStampTest()
+{
+}
+
+
+void FileStampTest::readTest()
+{
+    using namespace ScriptEmbedderNS;
+    QVERIFY(!FileStamp().isValid());
+    QVERIFY(FileStamp() != FileStamp());
+
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    QString path = dir.path() + "/script.txt";
+    FileStamp missing = FileStamp::read(path);
+    QVERIFY(!missing.isValid());
+    QVERIFY(missing != FileStamp::read(path));
+
+    QVERIFY(this->write(path, "abc"));
+    FileStamp stamp = FileStamp::read(path);
+    QVERIFY(stamp.isValid());
+    QVERIFY(stamp == FileStamp::read(path));
+    QVERIFY(stamp != missing);
+}
+
+
+void FileStampTest::changeTest()
+{
+    using namespace ScriptEmbedderNS;
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    QString path = dir.path() + "/script.txt";
+    QVERIFY(this->write(path, "abc"));
+    FileStamp original = FileStamp::read(path);
+
+    // Size changes.
+    QVERIFY(this->write(path, "abcd"));
+    FileStamp modified = FileStamp::read(path);
+    QVERIFY(modified != original);
+
+    // Replaced by renaming another file of same size.
+    QString other = dir.path() + "/other.txt";
+    QVERIFY(this->write(other, "efgh"));
+    QVERIFY(QFile::remove(path));
+    QVERIFY(QFile::rename(other, path));
+    QVERIFY(FileStamp::read(path) != modified);
+
+    // Removed.
+    QVERIFY(QFile::remove(path));
+    QVERIFY(!FileStamp::read(path).isValid());
+}
+
+
+bool FileStampTest::write(const QString& path, const QByteArray& contents) const
+{
+    QFile f(path);
+    if (!f.open(QFile::WriteOnly | QFile::Truncate)) return false;
+    return f.write(contents) == contents.size();
+}
+
+
+QTEST_APPLESS_MAIN(FileStampTest)
+
+#include "tst_filestamptest.moc"
@@ -0,0 +1,22 @@
+#-------------------------------------------------
+#
+# Project created by QtCreator 2016-06-21T18:02:37
+#
+#-------------------------------------------------
+
+QT       += testlib
+
+QT       -= gui
+
+TARGET = tst_flightrecordertest
+CONFIG   += console c++11
+CONFIG   -= app_bundle
+
+TEMPLATE = app
+
+INCLUDEPATH += ../../ScriptEmbedder/include
+
+SOURCES += tst_flightrecordertest.cc \
+           ../../ScriptEmbedder/src/flightrecorder.cc
+
+DEFINES += SRCDIR=\\\"$$PWD/\\\"
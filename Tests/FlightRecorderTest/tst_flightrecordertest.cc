@@ -0,0 +1,124 @@
+/**
+ * @file
+ * @brief Unit tests for the FlightRecorder class.
+ * @author Perttu Paarlahti 2016.
+ */
+
+#include <QString>
+#include <QtTest>
+#include <QTemporaryFile>
+#include "flightrecorder.hh"
+
+
+/**
+ * @brief Unit tests for the FlightRecorder class.
+ */
+class FlightRecorderTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    FlightRecorderTest();
+
+private Q_SLOTS:
+
+    /**
+     * @brief Test recording executions.
+     */
+    void recordTest();
+
+    /**
+     * @brief Test that oldest records are overwritten when ring is full.
+     */
+    void wrapTest();
+
+    /**
+     * @brief Test formatting records as text.
+     */
+    void dumpTest();
+
+    /**
+     * @brief Test writing records into a file descriptor.
+     */
+    void dumpToFileTest();
+};
+
+
+FlightRecorderTest::FlightRecorderTest()
+{
+}
+
+
+void FlightRecorderTest::recordTest()
+{
+    using namespace ScriptEmbedderNS;
+    FlightRecorder recorder(4u);
+    QCOMPARE(recorder.capacity(), 4u);
+    QVERIFY(recorder.entries().empty());
+
+    recorder.record(7u, 0x1234u, 500, ScriptInterpreter::SUCCESS,
+                    ScriptResultRecord::NONE, nullptr);
+    std::vector<FlightRecorder::Entry> entries = recorder.entries();
+    QVERIFY(entries.size() == 1);
+    QCOMPARE(entries.at(0).sequence, quint64(1));
+    QCOMPARE(entries.at(0).scriptId, 7u);
+    QCOMPARE(entries.at(0).paramsHash, 0x1234u);
+    QCOMPARE(entries.at(0).duration, qint64(500));
+    QVERIFY(entries.at(0).status == ScriptInterpreter::SUCCESS);
+    QVERIFY(entries.at(0).errorCode == ScriptResultRecord::NONE);
+    QCOMPARE(entries.at(0).interpreter, quintptr(0));
+}
+
+
+void FlightRecorderTest::wrapTest()
+{
+    using namespace ScriptEmbedderNS;
+    FlightRecorder recorder(3u);
+    for (unsigned i = 1; i <= 5; ++i) {
+        recorder.record(i, 0u, 10, ScriptInterpreter::FAILURE,
+                        ScriptResultRecord::SCRIPT_ERROR, nullptr);
+    }
+
+    std::vector<FlightRecorder::Entry> entries = recorder.entries();
+    QVERIFY(entries.size() == 3);
+    QCOMPARE(entries.at(0).scriptId, 3u);
+    QCOMPARE(entries.at(1).scriptId, 4u);
+    QCOMPARE(entries.at(2).scriptId, 5u);
+    QCOMPARE(entries.at(2).sequence, quint64(5));
+    QVERIFY(entries.at(0).start <= entries.at(2).start);
+}
+
+
+void FlightRecorderTest::dumpTest()
+{
+    using namespace ScriptEmbedderNS;
+    FlightRecorder recorder(4u);
+    QCOMPARE(recorder.dump(), QString());
+
+    recorder.record(2u, 0xabcu, 42, ScriptInterpreter::FAILURE,
+                    ScriptResultRecord::NO_SUCH_SCRIPT, nullptr);
+    QString text = recorder.dump();
+    QVERIFY(text.startsWith("#1 script=2 params=abc start="));
+    QVERIFY(text.contains(" duration=42ns result=FAILURE error=NO_SUCH_SCRIPT interpreter=0x0"));
+    QVERIFY(text.endsWith("\n"));
+}
+
+
+void FlightRecorderTest::dumpToFileTest()
+{
+    using namespace ScriptEmbedderNS;
+    FlightRecorder recorder(4u);
+    recorder.record(1u, 0u, 1, ScriptInterpreter::SUCCESS, ScriptResultRecord::NONE, nullptr);
+    recorder.record(2u, 0u, 1, ScriptInterpreter::SUCCESS, ScriptResultRecord::NONE, nullptr);
+
+    QTemporaryFile file;
+    QVERIFY(file.open());
+    QVERIFY(recorder.dump(file.handle()));
+    file.seek(0);
+    QCOMPARE(QString::fromLatin1(file.readAll()), recorder.dump());
+}
+
+
+QTEST_APPLESS_MAIN(FlightRecorderTest)
+
+#include "tst_flightrecordertest.moc"
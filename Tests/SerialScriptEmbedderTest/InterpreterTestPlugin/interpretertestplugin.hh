@@ -19,15 +19,25 @@ class TestInterpreter : public ScriptEmbedderNS::ScriptInterpreter
     std::shared_ptr<ScriptEmbedderNS::ScriptAPI>& myApi;
     QString& latestScript;
     QStringList& latestParams;
+    bool& preferUtf8;
+    QByteArray& latestUtf8Script;
+    bool& entryPoints;
+    QList<unsigned>& preparedHandles;
 
 public:
 
     TestInterpreter(std::shared_ptr<ScriptEmbedderNS::ScriptAPI>& api,
                     QString& script,
                     QStringList& params,
-                    ScriptEmbedderNS::ScriptInterpreter::ScriptRunResult& result) :
+                    ScriptEmbedderNS::ScriptInterpreter::ScriptRunResult& result,
+                    bool& utf8,
+                    QByteArray& utf8Script,
+                    bool& supportsEntryPoints,
+                    QList<unsigned>& prepared) :
         ScriptEmbedderNS::ScriptInterpreter(),
-        nextResult(result), myApi(api), latestScript(script), latestParams(params)
+        nextResult(result), myApi(api), latestScript(script), latestParams(params),
+        preferUtf8(utf8), latestUtf8Script(utf8Script),
+        entryPoints(supportsEntryPoints), preparedHandles(prepared)
     {
     }
 
@@ -45,6 +55,44 @@ public:
         return nextResult;
     }
 
+    bool prefersUtf8() const
+    {
+        return preferUtf8;
+    }
+
+    ScriptRunResult runScriptUtf8(const QByteArray& script, const QStringList& params)
+    {
+        // Copy, as the script may be a view to a mapped file.
+        latestUtf8Script = QByteArray(script.constData(), script.size());
+        latestParams = params;
+        return nextResult;
+    }
+
+    bool supportsEntryPoints() const
+    {
+        return entryPoints;
+    }
+
+    ScriptRunResult prepareScript(unsigned handle, const QString& script)
+    {
+        latestScript = script;
+        preparedHandles.append(handle);
+        return nextResult;
+    }
+
+    ScriptRunResult call(unsigned handle, const QString& function, const QStringList& args)
+    {
+        Q_UNUSED(handle);
+        Q_UNUSED(function);
+        latestParams = args;
+        return nextResult;
+    }
+
+    void releaseScript(unsigned handle)
+    {
+        preparedHandles.removeAll(handle);
+    }
+
     QString language() const
     {
         return "TestLanguage";
@@ -67,7 +115,8 @@ public:
 
     InterpreterTestPlugin() :
         QObject(), ScriptEmbedderNS::InterpreterPlugin(),
-        api(nullptr), result(), script(), params() {}
+        api(nullptr), result(), script(), params(), utf8(false), utf8Script(),
+        entryPoints(false), prepared() {}
 
     virtual ~InterpreterTestPlugin() {}
 
@@ -78,7 +127,8 @@ public:
 
     ScriptEmbedderNS::ScriptInterpreter* getInstance() const
     {
-        return new TestInterpreter(api, script, params, result);
+        return new TestInterpreter(api, script, params, result, utf8, utf8Script,
+                                   entryPoints, prepared);
     }
 
 
@@ -87,6 +137,10 @@ public:
     mutable ScriptEmbedderNS::ScriptInterpreter::ScriptRunResult result;
     mutable QString script;
     mutable QStringList params;
+    mutable bool utf8;
+    mutable QByteArray utf8Script;
+    mutable bool entryPoints;
+    mutable QList<unsigned> prepared;
 };
 
 
@@ -28,10 +28,23 @@ SOURCES += \
     ../../../ScriptEmbedder/src/serialscriptembedder.cc \
     ../../../ScriptEmbedder/src/configuration.cc \
     ../../../ScriptEmbedder/src/interpreterloader.cc \
+    ../../../ScriptEmbedder/src/logger.cc \
+    ../../../ScriptEmbedder/src/metricsregistry.cc \
+    ../../../ScriptEmbedder/src/executiontracer.cc \
+    ../../../ScriptEmbedder/src/flightrecorder.cc \
+    ../../../ScriptEmbedder/src/scriptsource.cc \
+    ../../../ScriptEmbedder/src/sourcecache.cc \
+    ../../../ScriptEmbedder/src/filestamp.cc \
+    ../../../ScriptEmbedder/src/sourceloader.cc \
+    ../../../ScriptEmbedder/src/sourcepool.cc \
+    ../../../ScriptEmbedder/src/successorpredictor.cc
 
 OTHER_FILES += \
     testfiles/empty.txt \
     testfiles/testscript.txt
 
+RESOURCES += \
+    testfiles.qrc
+
 
 DEFINES += SRCDIR=\\\"$$PWD/\\\"
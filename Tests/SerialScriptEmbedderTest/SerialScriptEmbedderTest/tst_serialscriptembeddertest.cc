@@ -6,6 +6,7 @@
 
 #include <QString>
 #include <QtTest>
+#include <QTemporaryDir>
 #include "serialscriptembedder.hh"
 #include "interpretertestplugin.hh"
 
@@ -72,6 +73,29 @@ public:
 };
 
 
+/**
+ * @brief Stub implementation for the BatchLogger interface.
+ */
+class BatchLoggerStub : public ScriptEmbedderNS::BatchLogger
+{
+public:
+
+    // Members for verifying tests.
+    std::vector<std::vector<ScriptEmbedderNS::ScriptResultRecord> > batches;
+
+    BatchLoggerStub() :
+        ScriptEmbedderNS::BatchLogger(), batches() {}
+
+    virtual ~BatchLoggerStub() {}
+
+    void scriptsFinished(const ScriptEmbedderNS::ScriptResultRecord* records,
+                         std::size_t count)
+    {
+        batches.push_back(std::vector<ScriptEmbedderNS::ScriptResultRecord>(records, records+count));
+    }
+};
+
+
 /**
  * @brief Unit tests for SerialScriptEmbedderTest.
  */
@@ -113,6 +137,11 @@ private Q_SLOTS:
      */
     void removeScriptTest();
 
+    /**
+     * @brief Test the addScripts and removeScripts methods.
+     */
+    void bulkScriptsTest();
+
     /**
      * @brief Test the addInterpreter method.
      */
@@ -124,6 +153,81 @@ private Q_SLOTS:
      */
     void runScriptTest();
     void runScriptTest_data();
+
+    /**
+     * @brief Test passing sources as UTF-8 to interpreters preferring it.
+     */
+    void utf8Test();
+
+    /**
+     * @brief Test caching sources of on-demand scripts until their file changes.
+     */
+    void cachedSourceTest();
+
+    /**
+     * @brief Test executing scripts whose sources have been prefetched.
+     */
+    void prefetchTest();
+
+    /**
+     * @brief Test promoting frequently executed scripts to RAM.
+     */
+    void promotionTest();
+
+    /**
+     * @brief Test that colder scripts are not demoted, if that does not
+     * free enough room for the promoted script.
+     */
+    void promotionRoomTest();
+
+    /**
+     * @brief Test prefetching predicted successors of executed scripts.
+     */
+    void predictivePrefetchTest();
+
+    /**
+     * @brief Test preparing entry-point scripts once and calling them on
+     * each execution, and rejecting entry points not supported.
+     */
+    void entryPointTest();
+
+    /**
+     * @brief Test sharing prepared programs between scripts having
+     * identical sources.
+     */
+    void sharedProgramTest();
+
+    /**
+     * @brief Test sharing decompressed copy of a source between scripts.
+     */
+    void sharedDecompressedSourceTest();
+
+    /**
+     * @brief Test delivering results to BatchLogger.
+     */
+    void batchLoggerTest();
+
+    /**
+     * @brief Test collecting execution metrics.
+     */
+    void metricsTest();
+
+    /**
+     * @brief Test tracing execution phases.
+     */
+    void tracerTest();
+
+    /**
+     * @brief Test recording executions into the flight recorder.
+     */
+    void flightRecorderTest();
+
+private:
+
+    bool write(const QString& path, const QByteArray& contents) const;
+    ScriptMap fileScripts(const QTemporaryDir& dir, const QList<QByteArray>& sources) const;
+    ScriptEmbedderNS::Configuration testConfiguration(const ScriptMap& scripts) const;
+    InterpreterTestPlugin* testPlugin() const;
 };
 
 
@@ -442,6 +546,23 @@ void SerialScriptEmbedderTest::addScriptTest_data()
             << QString("Could not add script: file '%1' does not exist.").arg("nofile.txt")
             << QString("Could not add script: file '%1' does not exist.").arg("nofile.txt");
 
+    QTest::newRow("Mapped to RAM")
+            << InterpreterMap {{"TestLanguage", InterpreterEntry("TestLanguage", PLUGIN_PATH)}}
+            << ScriptMap {{1u, ScriptEntry(1u, TEST_PATH+"testscript.txt", "TestLanguage", true, 1u)}}
+            << ScriptEntry(1u, TEST_PATH+"testscript.txt", "TestLanguage", true, 1u,
+                           QString(), ScriptEntry::MAPPED)
+            << true
+            << QString() << QString("Script '%1' replaced.").arg(1u);
+
+    QTest::newRow("Empty script mapped to RAM")
+            << InterpreterMap {{"TestLanguage", InterpreterEntry("TestLanguage", PLUGIN_PATH)}}
+            << ScriptMap()
+            << ScriptEntry(1u, TEST_PATH+"empty.txt", "TestLanguage", true, 1u,
+                           QString(), ScriptEntry::MAPPED)
+            << false
+            << QString("Could not add script %1: File '%2' does not open or is empty.").arg(1u).arg(TEST_PATH+"empty.txt")
+            << QString("Could not add script %1: File '%2' does not open or is empty.").arg(1u).arg(TEST_PATH+"empty.txt");
+
     QTest::newRow("Empty script to RAM")
             << InterpreterMap {{"TestLanguage", InterpreterEntry("TestLanguage", PLUGIN_PATH)}}
             << ScriptMap {{1u, ScriptEntry(1u, TEST_PATH+"empty.txt", "TestLanguage", false, 1u)}}
@@ -496,6 +617,78 @@ void SerialScriptEmbedderTest::removeScriptTest()
 }
 
 
+void SerialScriptEmbedderTest::bulkScriptsTest()
+{
+    using namespace ScriptEmbedderNS;
+    // Initialize embedder.
+    Configuration conf;
+    conf.setScriptAPI(std::shared_ptr<ScriptAPI>(new ScriptAPI()));
+    conf.addInterpreter(InterpreterEntry("TestLanguage", PLUGIN_PATH));
+    SerialScriptEmbedder embedder(conf);
+    QVERIFY(embedder.isValid());
+    ScriptEntry existing(0u, TEST_PATH+"testscript.txt", "TestLanguage", true, 0u);
+    QVERIFY(embedder.addScript(existing));
+    LoggerStub logger;
+    embedder.setLogger(&logger);
+
+    // Invalid entry prevents adding any scripts.
+    std::vector<ScriptEntry> scripts;
+    for (unsigned i = 1; i < 200; ++i) {
+        scripts.push_back(ScriptEntry(i, TEST_PATH+"testscript.txt", "TestLanguage", i % 2 == 0));
+    }
+    scripts.push_back(ScriptEntry(500u, TEST_PATH+"empty.txt", "TestLanguage", true));
+    scripts.push_back(ScriptEntry(501u, TEST_PATH+"testscript.txt", "OtherLanguage"));
+    QVERIFY(!embedder.addScripts(scripts));
+    QCOMPARE(embedder.errorString(),
+             QString("Could not add 201 scripts: 2 invalid.\n"
+                     "Could not add script %1: File '%2' does not open or is empty.\n"
+                     "Could not add script '%3': No suitable interpreter for language '%4'.")
+             .arg(500u).arg(TEST_PATH+"empty.txt").arg(501u).arg("OtherLanguage"));
+    QCOMPARE(logger.logMessages.size(), QStringList::size_type(1));
+    QCOMPARE(logger.logMessages.at(0), embedder.errorString());
+    QCOMPARE(embedder.configuration().scripts().size(), ScriptMap::size_type(1));
+
+    // Valid entries are added at once. Last entry with the same id wins.
+    scripts.pop_back();
+    scripts.back() = ScriptEntry(500u, TEST_PATH+"empty.txt", "TestLanguage", false);
+    scripts.push_back(existing);
+    ScriptEntry replacement(1u, TEST_PATH+"empty.txt", "TestLanguage", false, 2u);
+    scripts.push_back(replacement);
+    QVERIFY(embedder.addScripts(scripts));
+    QCOMPARE(logger.logMessages.size(), QStringList::size_type(2));
+    QCOMPARE(logger.logMessages.at(1),
+             QString("Scripts added: 200 new, 0 replaced, 1 already existed."));
+    ScriptMap scriptsNow = embedder.configuration().scripts();
+    QCOMPARE(scriptsNow.size(), ScriptMap::size_type(201));
+    QCOMPARE(scriptsNow.at(1u), replacement);
+    QCOMPARE(scriptsNow.at(2u), scripts.at(1));
+
+    // Script read to RAM is runnable.
+    embedder.execute(2u);
+    QCOMPARE(logger.successes.size() + logger.failures.size(), std::size_t(1));
+
+    // Replace existing.
+    std::vector<ScriptEntry> replacements {ScriptEntry(2u, TEST_PATH+"testscript.txt", "TestLanguage")};
+    QVERIFY(embedder.addScripts(replacements));
+    QCOMPARE(logger.logMessages.at(logger.logMessages.size()-1),
+             QString("Scripts added: 0 new, 1 replaced, 0 already existed."));
+
+    // Remove existing and non-existing scripts.
+    std::vector<unsigned> ids;
+    for (unsigned i = 0; i < 150; ++i) {
+        ids.push_back(i);
+    }
+    ids.push_back(1000u);
+    int messages = logger.logMessages.size();
+    embedder.removeScripts(ids);
+    QCOMPARE(logger.logMessages.size(), messages + 1);
+    QCOMPARE(logger.logMessages.back(), QString("Scripts removed: 150 removed, 1 did not exist."));
+    QCOMPARE(embedder.configuration().scripts().size(), ScriptMap::size_type(51));
+    QVERIFY(!embedder.configuration().hasScript(0u));
+    QVERIFY(embedder.configuration().hasScript(150u));
+}
+
+
 void SerialScriptEmbedderTest::addInterpreterTest()
 {
     using namespace ScriptEmbedderNS;
@@ -603,6 +796,15 @@ void SerialScriptEmbedderTest::runScriptTest()
         QCOMPARE(std::get<0>(logger.successes.at(0)), scripts[runId]);
         QCOMPARE(std::get<1>(logger.successes.at(0)), runParams);
         QCOMPARE(std::get<2>(logger.successes.at(0)), returnValue);
+
+        if (scripts[runId].isInline()) {
+            QCOMPARE(plugin->script, scripts[runId].source);
+        }
+        else {
+            QFile f(scripts[runId].scriptPath);
+            QVERIFY(f.open(QFile::ReadOnly));
+            QCOMPARE(plugin->script, QString::fromUtf8(f.readAll()));
+        }
     }
     else
     {
@@ -630,6 +832,34 @@ void SerialScriptEmbedderTest::runScriptTest_data()
             << ScriptMap {{0u, ScriptEntry(0u, TEST_PATH+"testscript.txt", "TestLanguage", true, 1u)}}
             << 0u << QStringList{"1", "2", "abc"} << 1 << QString();
 
+    QTest::newRow("mapped success")
+            << ScriptMap {{3u, ScriptEntry(3u, TEST_PATH+"testscript.txt", "TestLanguage", true, 1u,
+                                           QString(), ScriptEntry::MAPPED)}}
+            << 3u << QStringList{"1"} << 2 << QString();
+
+    QTest::newRow("compressed success")
+            << ScriptMap {{4u, ScriptEntry(4u, TEST_PATH+"testscript.txt", "TestLanguage", true, 1u,
+                                           QString(), ScriptEntry::COMPRESSED)}}
+            << 4u << QStringList{"1"} << 3 << QString();
+
+    QTest::newRow("inline success")
+            << ScriptMap {{5u, ScriptEntry::fromSource(5u, "inline script", "TestLanguage")}}
+            << 5u << QStringList{"1"} << 4 << QString();
+
+    QTest::newRow("compressed inline success")
+            << ScriptMap {{6u, ScriptEntry::fromSource(6u, "inline script", "TestLanguage", 0u,
+                                                       QString(), ScriptEntry::COMPRESSED)}}
+            << 6u << QStringList{"1"} << 5 << QString();
+
+    QTest::newRow("resource success")
+            << ScriptMap {{7u, ScriptEntry(7u, ":/testfiles/testscript.txt", "TestLanguage", false)}}
+            << 7u << QStringList{"1"} << 6 << QString();
+
+    QTest::newRow("mapped resource success")
+            << ScriptMap {{8u, ScriptEntry(8u, ":/testfiles/testscript.txt", "TestLanguage", true, 0u,
+                                           QString(), ScriptEntry::MAPPED)}}
+            << 8u << QStringList{"1"} << 7 << QString();
+
     QTest::newRow("failure")
             << ScriptMap{{10u, ScriptEntry(10u, TEST_PATH+"testscript.txt", "TestLanguage", false, 4u)}}
             << 10u << QStringList{"3,14", "asd", "0"} << 0 << QString("Syntax error");
@@ -642,6 +872,712 @@ void SerialScriptEmbedderTest::runScriptTest_data()
             << ScriptMap{{1u, ScriptEntry(1u, TEST_PATH+"empty.txt", "TestLanguage", false, 4u)}}
             << 1u << QStringList{"a", "b", "124"} << 0
             << QString("File '%1' does not open or is empty.").arg(TEST_PATH+"empty.txt");
+
+}
+
+
+void SerialScriptEmbedderTest::utf8Test()
+{
+    using namespace ScriptEmbedderNS;
+    QPluginLoader loader(PLUGIN_PATH);
+    InterpreterTestPlugin* plugin = ((InterpreterTestPlugin*)loader.instance());
+    QVERIFY(plugin != nullptr);
+    plugin->result.result = ScriptInterpreter::SUCCESS;
+    plugin->result.returnValue = 0;
+    plugin->utf8 = true;
+
+    QFile f(TEST_PATH+"testscript.txt");
+    QVERIFY(f.open(QFile::ReadOnly));
+    QByteArray contents = f.readAll();
+
+    std::shared_ptr<ScriptAPI> api(new ScriptAPI());
+    InterpreterMap interpreters {{"TestLanguage", InterpreterEntry("TestLanguage", PLUGIN_PATH)}};
+    ScriptMap scripts {
+        {0u, ScriptEntry(0u, TEST_PATH+"testscript.txt", "TestLanguage", true)},
+        {1u, ScriptEntry(1u, TEST_PATH+"testscript.txt", "TestLanguage", true, 0u,
+                         QString(), ScriptEntry::MAPPED)},
+        {2u, ScriptEntry(2u, TEST_PATH+"testscript.txt", "TestLanguage", false)},
+        {3u, ScriptEntry(3u, TEST_PATH+"testscript.txt", "TestLanguage", true, 0u,
+                         QString(), ScriptEntry::COMPRESSED)}
+    };
+    SerialScriptEmbedder embedder(Configuration(api, interpreters, scripts));
+    QVERIFY(embedder.isValid());
+    LoggerStub logger;
+    embedder.setLogger(&logger);
+
+    // Compressed script is executed twice to use the decompressed copy.
+    std::vector<unsigned> ids {0u, 1u, 2u, 3u, 3u};
+    for (auto id : ids) {
+        plugin->script.clear();
+        plugin->utf8Script.clear();
+        embedder.execute(id, QStringList{"p"});
+        QCOMPARE(plugin->utf8Script, contents);
+        QVERIFY(plugin->script.isNull());
+        QCOMPARE(plugin->params, QStringList{"p"});
+    }
+    QCOMPARE(logger.successes.size(), ids.size());
+    plugin->utf8 = false;
+    loader.unload();
+}
+
+
+void SerialScriptEmbedderTest::cachedSourceTest()
+{
+    using namespace ScriptEmbedderNS;
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    QString path = dir.path() + "/cached.txt";
+    QVERIFY(this->write(path, "first"));
+
+    // Script 0 is checked on each execution, script 1 only once an hour.
+    ScriptEntry checked(0u, path, "TestLanguage");
+    checked.checkInterval = 0;
+    ScriptEntry limited(1u, path, "TestLanguage");
+    limited.checkInterval = 60 * 60 * 1000;
+    QVERIFY(checked.isCached());
+    QVERIFY(limited.isCached());
+
+    SerialScriptEmbedder embedder(this->testConfiguration(ScriptMap{{0u, checked}, {1u, limited}}));
+    QVERIFY(embedder.isValid());
+    BatchLoggerStub logger;
+    embedder.setBatchLogger(&logger, 1u, 0u);
+    InterpreterTestPlugin* plugin = this->testPlugin();
+
+    // Source is read only on first execution.
+    embedder.execute(0u);
+    QCOMPARE(plugin->script, QString("first"));
+    QVERIFY(logger.batches.back().at(0).timing.load >= 0);
+    embedder.execute(0u);
+    QCOMPARE(plugin->script, QString("first"));
+    QVERIFY(logger.batches.back().at(0).timing.load == -1);
+    embedder.execute(1u);
+    QCOMPARE(plugin->script, QString("first"));
+
+    // Changed file is read again, unless check is not due yet.
+    QVERIFY(this->write(path, "second"));
+    embedder.execute(0u);
+    QCOMPARE(plugin->script, QString("second"));
+    QVERIFY(logger.batches.back().at(0).timing.load >= 0);
+    embedder.execute(1u);
+    QCOMPARE(plugin->script, QString("first"));
+
+    // Removed file.
+    QVERIFY(QFile::remove(path));
+    embedder.execute(0u);
+    QVERIFY(logger.batches.back().at(0).errorCode == ScriptResultRecord::SOURCE_NOT_AVAILABLE);
+    QVERIFY(this->write(path, "third"));
+    embedder.execute(0u);
+    QCOMPARE(plugin->script, QString("third"));
+}
+
+
+void SerialScriptEmbedderTest::prefetchTest()
+{
+    using namespace ScriptEmbedderNS;
+    QFile f(TEST_PATH+"testscript.txt");
+    QVERIFY(f.open(QFile::ReadOnly));
+    QString contents = QString::fromUtf8(f.readAll());
+
+    std::shared_ptr<ScriptAPI> api(new ScriptAPI());
+    InterpreterMap interpreters {{"TestLanguage", InterpreterEntry("TestLanguage", PLUGIN_PATH)}};
+    ScriptMap scripts {
+        {0u, ScriptEntry(0u, TEST_PATH+"testscript.txt", "TestLanguage")},
+        {1u, ScriptEntry(1u, TEST_PATH+"testscript.txt", "TestLanguage", true)},
+        {2u, ScriptEntry(2u, TEST_PATH+"empty.txt", "TestLanguage")}
+    };
+    SerialScriptEmbedder embedder(Configuration(api, interpreters, scripts));
+    QVERIFY(embedder.isValid());
+    LoggerStub logger;
+    embedder.setLogger(&logger);
+
+    QPluginLoader loader(PLUGIN_PATH);
+    InterpreterTestPlugin* plugin = ((InterpreterTestPlugin*)loader.instance());
+    loader.unload();
+    plugin->result.result = ScriptInterpreter::SUCCESS;
+    plugin->result.returnValue = 0;
+
+    // Missing and RAM scripts are ignored.
+    embedder.prefetch(std::vector<unsigned>{0u, 1u, 2u, 99u});
+    for (unsigned id = 0; id < 3; ++id) {
+        plugin->script.clear();
+        embedder.execute(id);
+        if (id < 2) {
+            QCOMPARE(plugin->script, contents);
+        }
+    }
+    QCOMPARE(logger.successes.size(), std::size_t(2));
+    QCOMPARE(logger.failures.size(), std::size_t(1));
+    QCOMPARE(std::get<0>(logger.failures.at(0)).id, 2u);
+
+    // Prefetched source is not used after script has been replaced.
+    embedder.prefetch(std::vector<unsigned>{0u, 0u});
+    QVERIFY(embedder.addScript(ScriptEntry(0u, TEST_PATH+"empty.txt", "TestLanguage")));
+    embedder.execute(0u);
+    QCOMPARE(logger.failures.size(), std::size_t(2));
+
+    // Prefetching is harmless, if script is not executed.
+    embedder.prefetch(std::vector<unsigned>{2u});
+    embedder.removeScript(2u);
+}
+
+
+void SerialScriptEmbedderTest::promotionTest()
+{
+    using namespace ScriptEmbedderNS;
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    ScriptMap scripts = this->fileScripts(dir, QList<QByteArray>{"source a", "source b"});
+    QCOMPARE(scripts.size(), ScriptMap::size_type(2));
+    SerialScriptEmbedder embedder(this->testConfiguration(scripts));
+    QVERIFY(embedder.isValid());
+    LoggerStub logger;
+    embedder.setLogger(&logger);
+    BatchLoggerStub batchLogger;
+    embedder.setBatchLogger(&batchLogger, 1u, 0u);
+    InterpreterTestPlugin* plugin = this->testPlugin();
+
+    // Room for one of the sources only.
+    embedder.setPromotionLimit(20);
+    for (int i = 0; i < 10; ++i) {
+        embedder.execute(0u);
+    }
+    QCOMPARE(logger.logMessages.count("Script '0' promoted to RAM."), 1);
+    embedder.execute(0u);
+    QVERIFY(batchLogger.batches.back().at(0).timing.load == -1);
+
+    // Promoted script is read again when its file changes.
+    QVERIFY(this->write(scripts.at(0u).scriptPath, "changed a"));
+    embedder.execute(0u);
+    QCOMPARE(plugin->script, QString("changed a"));
+    QVERIFY(batchLogger.batches.back().at(0).timing.load >= 0);
+
+    // Hotter script replaces the colder one.
+    for (int i = 0; i < 20; ++i) {
+        embedder.execute(1u);
+        QCOMPARE(plugin->script, QString("source b"));
+    }
+    QCOMPARE(logger.logMessages.count("Script '0' demoted from RAM."), 1);
+    QCOMPARE(logger.logMessages.count("Script '1' promoted to RAM."), 1);
+    embedder.execute(0u);
+    QCOMPARE(plugin->script, QString("changed a"));
+    QVERIFY(batchLogger.batches.back().at(0).timing.load >= 0);
+
+    // Disabling promotion demotes all scripts.
+    embedder.setPromotionLimit(0);
+    QCOMPARE(logger.logMessages.count("Script '1' demoted from RAM."), 1);
+    QCOMPARE(logger.failures.size(), std::size_t(0));
+}
+
+
+void SerialScriptEmbedderTest::promotionRoomTest()
+{
+    using namespace ScriptEmbedderNS;
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    ScriptMap scripts = this->fileScripts(dir, QList<QByteArray>{"src x", "src y", "source z"});
+    QCOMPARE(scripts.size(), ScriptMap::size_type(3));
+    SerialScriptEmbedder embedder(this->testConfiguration(scripts));
+    QVERIFY(embedder.isValid());
+    LoggerStub logger;
+    embedder.setLogger(&logger);
+    InterpreterTestPlugin* plugin = this->testPlugin();
+
+    // Sources take 10 bytes each as strings, and fill the limit.
+    embedder.setPromotionLimit(20);
+    for (int i = 0; i < 8; ++i) {
+        embedder.execute(0u);
+    }
+    for (int i = 0; i < 40; ++i) {
+        embedder.execute(1u);
+    }
+    QCOMPARE(logger.logMessages.count("Script '0' promoted to RAM."), 1);
+    QCOMPARE(logger.logMessages.count("Script '1' promoted to RAM."), 1);
+
+    // Demoting the colder script alone would not make room for 16 bytes.
+    for (int i = 0; i < 20; ++i) {
+        embedder.execute(2u);
+        QCOMPARE(plugin->script, QString("source z"));
+    }
+    QCOMPARE(logger.logMessages.count("Script '0' demoted from RAM."), 0);
+    QCOMPARE(logger.logMessages.count("Script '2' promoted to RAM."), 0);
+
+    // Larger limit allows promotion without waiting for the next sweep.
+    embedder.setPromotionLimit(36);
+    embedder.execute(2u);
+    QCOMPARE(logger.logMessages.count("Script '2' promoted to RAM."), 1);
+    QCOMPARE(logger.logMessages.count("Script '0' demoted from RAM."), 0);
+    QCOMPARE(logger.failures.size(), std::size_t(0));
+}
+
+
+void SerialScriptEmbedderTest::predictivePrefetchTest()
+{
+    using namespace ScriptEmbedderNS;
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    ScriptMap scripts = this->fileScripts(dir, QList<QByteArray>{"source a", "source b", "source c"});
+    QCOMPARE(scripts.size(), ScriptMap::size_type(3));
+    SerialScriptEmbedder embedder(this->testConfiguration(scripts));
+    QVERIFY(embedder.isValid());
+    LoggerStub logger;
+    embedder.setLogger(&logger);
+    InterpreterTestPlugin* plugin = this->testPlugin();
+
+    // Chain 0 -> 1 -> 2 is learned, and executes with predicted sources.
+    embedder.setPredictivePrefetch(true);
+    const QStringList expected {"source a", "source b", "source c"};
+    for (int i = 0; i < 10; ++i) {
+        for (unsigned id = 0; id < 3; ++id) {
+            embedder.execute(id);
+            QCOMPARE(plugin->script, expected.at(int(id)));
+        }
+    }
+
+    // Removed successor is not predicted.
+    embedder.removeScript(1u);
+    embedder.execute(0u);
+    QCOMPARE(plugin->script, QString("source a"));
+    embedder.execute(2u);
+    QCOMPARE(plugin->script, QString("source c"));
+
+    // Replaced successor is read from its new file.
+    QVERIFY(embedder.addScript(ScriptEntry(2u, scripts.at(1u).scriptPath, "TestLanguage")));
+    embedder.execute(0u);
+    embedder.execute(2u);
+    QCOMPARE(plugin->script, QString("source b"));
+
+    embedder.setPredictivePrefetch(false);
+    embedder.execute(0u);
+    QCOMPARE(plugin->script, QString("source a"));
+    QCOMPARE(logger.failures.size(), std::size_t(0));
+    QCOMPARE(logger.successes.size(), std::size_t(35));
+}
+
+
+void SerialScriptEmbedderTest::entryPointTest()
+{
+    using namespace ScriptEmbedderNS;
+    QPluginLoader loader(PLUGIN_PATH);
+    InterpreterTestPlugin* plugin = ((InterpreterTestPlugin*)loader.instance());
+    QVERIFY(plugin != nullptr);
+    plugin->result.result = ScriptInterpreter::SUCCESS;
+    plugin->result.returnValue = 3;
+    plugin->prepared.clear();
+
+    std::shared_ptr<ScriptAPI> api(new ScriptAPI());
+    InterpreterMap interpreters {{"TestLanguage", InterpreterEntry("TestLanguage", PLUGIN_PATH)}};
+    ScriptEntry script(0u, TEST_PATH+"testscript.txt", "TestLanguage", false, 0u, "main");
+    ScriptEntry plain(1u, TEST_PATH+"testscript.txt", "TestLanguage");
+
+    // Entry points are rejected when they are added.
+    plugin->entryPoints = false;
+    {
+        SerialScriptEmbedder embedder(Configuration(api, interpreters, ScriptMap{{0u, script}}));
+        QVERIFY(!embedder.isValid());
+        QVERIFY(embedder.reset(Configuration(api, interpreters, ScriptMap{{1u, plain}})));
+        QVERIFY(!embedder.addScript(script));
+        QCOMPARE(embedder.errorString(),
+                 QString("Could not add script '0': Interpreter for 'TestLanguage' "
+                         "does not support entry points."));
+        QVERIFY(!embedder.addScripts(std::vector<ScriptEntry>{script}));
+        QVERIFY(!embedder.configuration().hasScript(0u));
+    }
+
+    // Script is prepared on first execution, and each execution calls it.
+    plugin->entryPoints = true;
+    {
+        SerialScriptEmbedder embedder(Configuration(api, interpreters, ScriptMap{{0u, script}}));
+        QVERIFY(embedder.isValid());
+        LoggerStub logger;
+        embedder.setLogger(&logger);
+
+        for (int i = 0; i < 5; ++i) {
+            plugin->script.clear();
+            embedder.execute(0u, QStringList{QString::number(i)});
+            QCOMPARE(plugin->params, QStringList{QString::number(i)});
+            QCOMPARE(plugin->prepared.size(), 1);
+            QCOMPARE(plugin->script.isEmpty(), i != 0);
+        }
+        QCOMPARE(logger.successes.size(), std::size_t(5));
+        QCOMPARE(std::get<2>(logger.successes.back()), 3);
+        QCOMPARE(logger.failures.size(), std::size_t(0));
+
+        // Prepared script is not promoted to RAM.
+        embedder.setPromotionLimit(1024);
+        for (int i = 0; i < 20; ++i) {
+            embedder.execute(0u);
+        }
+        QCOMPARE(logger.logMessages.count("Script '0' promoted to RAM."), 0);
+        QCOMPARE(plugin->prepared.size(), 1);
+
+        embedder.removeScript(0u);
+        QVERIFY(plugin->prepared.isEmpty());
+    }
+    plugin->entryPoints = false;
+    loader.unload();
+}
+
+
+void SerialScriptEmbedderTest::sharedProgramTest()
+{
+    using namespace ScriptEmbedderNS;
+    QPluginLoader loader(PLUGIN_PATH);
+    InterpreterTestPlugin* plugin = ((InterpreterTestPlugin*)loader.instance());
+    QVERIFY(plugin != nullptr);
+    plugin->result.result = ScriptInterpreter::SUCCESS;
+    plugin->result.returnValue = 0;
+    plugin->entryPoints = true;
+    plugin->prepared.clear();
+
+    // Scripts 0-2 have identical sources.
+    std::shared_ptr<ScriptAPI> api(new ScriptAPI());
+    InterpreterMap interpreters {{"TestLanguage", InterpreterEntry("TestLanguage", PLUGIN_PATH)}};
+    ScriptMap scripts {
+        {0u, ScriptEntry(0u, TEST_PATH+"testscript.txt", "TestLanguage", true, 0u, "main")},
+        {1u, ScriptEntry(1u, TEST_PATH+"testscript.txt", "TestLanguage", false, 0u, "other")},
+        {2u, ScriptEntry(2u, TEST_PATH+"testscript.txt", "TestLanguage", true, 0u, "main",
+                         ScriptEntry::COMPRESSED)},
+        {3u, ScriptEntry::fromSource(3u, "different", "TestLanguage", 0u, "main")}
+    };
+    {
+        SerialScriptEmbedder embedder(Configuration(api, interpreters, scripts));
+        QVERIFY(embedder.isValid());
+        LoggerStub logger;
+        embedder.setLogger(&logger);
+
+        std::vector<unsigned> ids {0u, 1u, 2u, 3u, 0u, 1u};
+        for (auto id : ids) {
+            embedder.execute(id, QStringList{"a"});
+            QCOMPARE(plugin->params, QStringList{"a"});
+        }
+        QCOMPARE(logger.successes.size(), ids.size());
+        QCOMPARE(plugin->prepared.size(), 2);
+
+        // Program is released with its last script.
+        embedder.removeScript(0u);
+        embedder.removeScript(1u);
+        QCOMPARE(plugin->prepared.size(), 2);
+        embedder.removeScript(2u);
+        QCOMPARE(plugin->prepared.size(), 1);
+
+        // Replaced source is prepared again.
+        QVERIFY(embedder.addScript(ScriptEntry::fromSource(4u, "different", "TestLanguage",
+                                                           0u, "main")));
+        embedder.execute(4u);
+        QCOMPARE(plugin->prepared.size(), 1);
+        QVERIFY(embedder.addScript(ScriptEntry::fromSource(4u, "new", "TestLanguage",
+                                                           0u, "main")));
+        embedder.execute(4u);
+        QCOMPARE(plugin->prepared.size(), 2);
+        QCOMPARE(plugin->script, QString("new"));
+    }
+    plugin->entryPoints = false;
+    loader.unload();
+}
+
+
+void SerialScriptEmbedderTest::sharedDecompressedSourceTest()
+{
+    using namespace ScriptEmbedderNS;
+    std::shared_ptr<ScriptAPI> api(new ScriptAPI());
+    InterpreterMap interpreters {{"TestLanguage", InterpreterEntry("TestLanguage", PLUGIN_PATH)}};
+    ScriptEntry compressed(0u, TEST_PATH+"testscript.txt", "TestLanguage", true, 0u,
+                           QString(), ScriptEntry::COMPRESSED);
+    ScriptEntry other = compressed;
+    other.id = 1u;
+    ScriptMap scripts {{0u, compressed}, {1u, other}};
+    SerialScriptEmbedder embedder(Configuration(api, interpreters, scripts));
+    QVERIFY(embedder.isValid());
+    BatchLoggerStub batchLogger;
+    embedder.setBatchLogger(&batchLogger, 1u, 0u);
+
+    QPluginLoader loader(PLUGIN_PATH);
+    InterpreterTestPlugin* plugin = ((InterpreterTestPlugin*)loader.instance());
+    loader.unload();
+    plugin->result.result = ScriptInterpreter::SUCCESS;
+    plugin->result.returnValue = 0;
+
+    // Source is decompressed once for both scripts.
+    embedder.execute(0u);
+    QVERIFY(batchLogger.batches.back().at(0).timing.decode >= 0);
+    embedder.execute(1u);
+    QCOMPARE(batchLogger.batches.back().at(0).timing.decode, qint64(-1));
+
+    // Decompressed copy is kept while a script uses the source.
+    embedder.removeScript(0u);
+    embedder.execute(1u);
+    QCOMPARE(batchLogger.batches.back().at(0).timing.decode, qint64(-1));
+
+    // And dropped with the last script.
+    embedder.removeScript(1u);
+    QVERIFY(embedder.addScript(compressed));
+    embedder.execute(0u);
+    QVERIFY(batchLogger.batches.back().at(0).timing.decode >= 0);
+    QFile f(TEST_PATH+"testscript.txt");
+    QVERIFY(f.open(QFile::ReadOnly));
+    QCOMPARE(plugin->script, QString::fromUtf8(f.readAll()));
+}
+
+
+void SerialScriptEmbedderTest::batchLoggerTest()
+{
+    using namespace ScriptEmbedderNS;
+    // Initialize embedder.
+    Configuration conf;
+    conf.setScriptAPI(std::shared_ptr<ScriptAPI>(new ScriptAPI()));
+    conf.addInterpreter(InterpreterEntry("TestLanguage", PLUGIN_PATH));
+    conf.addScript(ScriptEntry(0u, TEST_PATH+"testscript.txt", "TestLanguage", true, 0u));
+    conf.addScript(ScriptEntry(1u, TEST_PATH+"empty.txt", "TestLanguage", false, 0u));
+    SerialScriptEmbedder embedder(conf);
+    QVERIFY(embedder.isValid());
+    BatchLoggerStub batchLogger;
+    embedder.setBatchLogger(&batchLogger, 2u, 60000u);
+
+    // Initialize plugin
+    QPluginLoader loader(PLUGIN_PATH);
+    InterpreterTestPlugin* plugin = ((InterpreterTestPlugin*)loader.instance());
+    loader.unload();
+    plugin->result.result = ScriptInterpreter::SUCCESS;
+    plugin->result.returnValue = 7;
+
+    // Batch is delivered when it is full.
+    embedder.execute(0u);
+    QVERIFY(batchLogger.batches.empty());
+    embedder.execute(1u);
+    QVERIFY(batchLogger.batches.size() == 1);
+    QVERIFY(batchLogger.batches.at(0).size() == 2);
+    QCOMPARE(batchLogger.batches.at(0).at(0).scriptId, 0u);
+    QVERIFY(batchLogger.batches.at(0).at(0).status == ScriptInterpreter::SUCCESS);
+    QCOMPARE(batchLogger.batches.at(0).at(0).returnValue, 7);
+    QVERIFY(batchLogger.batches.at(0).at(0).errorCode == ScriptResultRecord::NONE);
+    QVERIFY(batchLogger.batches.at(0).at(0).duration >= 0);
+    QCOMPARE(batchLogger.batches.at(0).at(1).scriptId, 1u);
+    QVERIFY(batchLogger.batches.at(0).at(1).status == ScriptInterpreter::FAILURE);
+    QVERIFY(batchLogger.batches.at(0).at(1).errorCode == ScriptResultRecord::SOURCE_NOT_AVAILABLE);
+
+    // Phase timings: script 0 is in RAM, script 1 is loaded on demand.
+    const ExecutionTiming& ramTiming = batchLogger.batches.at(0).at(0).timing;
+    QVERIFY(ramTiming.lookup >= 0);
+    QVERIFY(ramTiming.load == -1);
+    QVERIFY(ramTiming.decode == -1);
+    QVERIFY(ramTiming.run >= 0);
+    QVERIFY(ramTiming.log == -1);
+    const ExecutionTiming& fileTiming = batchLogger.batches.at(0).at(1).timing;
+    QVERIFY(fileTiming.lookup >= 0);
+    QVERIFY(fileTiming.load >= 0);
+    QVERIFY(fileTiming.decode >= 0);
+    QVERIFY(fileTiming.run == -1);
+
+    // Partial batch is delivered on flush.
+    embedder.execute(5u);
+    QVERIFY(batchLogger.batches.size() == 1);
+    embedder.flushResults();
+    QVERIFY(batchLogger.batches.size() == 2);
+    QVERIFY(batchLogger.batches.at(1).size() == 1);
+    QCOMPARE(batchLogger.batches.at(1).at(0).scriptId, 5u);
+    QVERIFY(batchLogger.batches.at(1).at(0).errorCode == ScriptResultRecord::NO_SUCH_SCRIPT);
+
+    // Expired partial batch is delivered without executing more scripts.
+    embedder.setBatchLogger(&batchLogger, 100u, 200u);
+    embedder.execute(5u);
+    embedder.flushExpired();
+    QVERIFY(batchLogger.batches.size() == 2);
+    QTest::qSleep(250);
+    embedder.flushExpired();
+    QVERIFY(batchLogger.batches.size() == 3);
+    QVERIFY(batchLogger.batches.at(2).size() == 1);
+
+    // Nothing is buffered after batch logger is removed.
+    embedder.setBatchLogger(nullptr, 2u, 60000u);
+    embedder.execute(0u);
+    embedder.flushResults();
+    QVERIFY(batchLogger.batches.size() == 2);
+}
+
+
+void SerialScriptEmbedderTest::metricsTest()
+{
+    using namespace ScriptEmbedderNS;
+    // Initialize embedder.
+    Configuration conf;
+    conf.setScriptAPI(std::shared_ptr<ScriptAPI>(new ScriptAPI()));
+    conf.addInterpreter(InterpreterEntry("TestLanguage", PLUGIN_PATH));
+    conf.addScript(ScriptEntry(0u, TEST_PATH+"testscript.txt", "TestLanguage", true, 0u));
+    conf.addScript(ScriptEntry(1u, TEST_PATH+"empty.txt", "TestLanguage", false, 0u));
+    SerialScriptEmbedder embedder(conf);
+    QVERIFY(embedder.isValid());
+    QVERIFY(embedder.metrics().scripts.empty());
+    QVERIFY(embedder.metrics().languages.empty());
+
+    // Initialize plugin
+    QPluginLoader loader(PLUGIN_PATH);
+    InterpreterTestPlugin* plugin = ((InterpreterTestPlugin*)loader.instance());
+    loader.unload();
+    plugin->result.result = ScriptInterpreter::SUCCESS;
+    plugin->result.returnValue = 0;
+
+    embedder.execute(0u);
+    embedder.execute(0u);
+    embedder.execute(1u); // Fails: empty file.
+    embedder.execute(2u); // No such script.
+
+    MetricsSnapshot metrics = embedder.metrics();
+    QVERIFY(metrics.scripts.size() == 2);
+    const ExecutionMetrics& ramScript = metrics.scripts.at(0u);
+    QCOMPARE(ramScript.runs, quint64(2));
+    QCOMPARE(ramScript.failures, quint64(0));
+    QCOMPARE(ramScript.latency.count, quint64(2));
+    QVERIFY(ramScript.latency.p50 <= ramScript.latency.p99);
+    QVERIFY(ramScript.latency.p99 <= ramScript.latency.max);
+    QCOMPARE(ramScript.sourceLoad.count, quint64(0));
+    QCOMPARE(ramScript.queueWait.count, quint64(0));
+
+    const ExecutionMetrics& diskScript = metrics.scripts.at(1u);
+    QCOMPARE(diskScript.runs, quint64(1));
+    QCOMPARE(diskScript.failures, quint64(1));
+    QCOMPARE(diskScript.sourceLoad.count, quint64(1));
+
+    QVERIFY(metrics.languages.size() == 1);
+    QCOMPARE(metrics.languages.at("TestLanguage").runs, quint64(3));
+    QCOMPARE(metrics.languages.at("TestLanguage").failures, quint64(1));
+    QCOMPARE(metrics.languages.at("TestLanguage").latency.count, quint64(3));
+
+    // Metrics of removed scripts are dropped, language totals remain.
+    embedder.removeScript(0u);
+    embedder.removeScripts(std::vector<unsigned>{1u});
+    metrics = embedder.metrics();
+    QVERIFY(metrics.scripts.empty());
+    QCOMPARE(metrics.languages.at("TestLanguage").runs, quint64(3));
+}
+
+
+void SerialScriptEmbedderTest::tracerTest()
+{
+    using namespace ScriptEmbedderNS;
+    // Initialize embedder.
+    Configuration conf;
+    conf.setScriptAPI(std::shared_ptr<ScriptAPI>(new ScriptAPI()));
+    conf.addInterpreter(InterpreterEntry("TestLanguage", PLUGIN_PATH));
+    conf.addScript(ScriptEntry(0u, TEST_PATH+"testscript.txt", "TestLanguage", true, 0u));
+    conf.addScript(ScriptEntry(1u, TEST_PATH+"testscript.txt", "TestLanguage", false, 0u));
+    SerialScriptEmbedder embedder(conf);
+    QVERIFY(embedder.isValid());
+    ExecutionTracer tracer(64u);
+    embedder.setTracer(&tracer);
+
+    // Initialize plugin
+    QPluginLoader loader(PLUGIN_PATH);
+    InterpreterTestPlugin* plugin = ((InterpreterTestPlugin*)loader.instance());
+    loader.unload();
+    plugin->result.result = ScriptInterpreter::SUCCESS;
+    plugin->result.returnValue = 0;
+
+    // Script in RAM: enqueue and run.
+    embedder.execute(0u);
+    std::vector<ExecutionTracer::Span> spans = tracer.spans();
+    QVERIFY(spans.size() == 2);
+    QVERIFY(spans.at(0).phase == ExecutionTracer::ENQUEUE);
+    QVERIFY(spans.at(1).phase == ExecutionTracer::RUN);
+    QCOMPARE(spans.at(1).scriptId, 0u);
+    QCOMPARE(spans.at(1).language, QString("TestLanguage"));
+    QVERIFY(spans.at(1).interpreter != nullptr);
+    QVERIFY(spans.at(0).end <= spans.at(1).begin);
+
+    // Script loaded on demand, with logger: enqueue, load, run and log.
+    LoggerStub logger;
+    embedder.setLogger(&logger);
+    tracer.clear();
+    embedder.execute(1u);
+    spans = tracer.spans();
+    QVERIFY(spans.size() == 4);
+    QVERIFY(spans.at(1).phase == ExecutionTracer::LOAD);
+    QVERIFY(spans.at(2).phase == ExecutionTracer::RUN);
+    QVERIFY(spans.at(3).phase == ExecutionTracer::LOG);
+
+    // Nothing is traced after tracer is removed.
+    embedder.setTracer(nullptr);
+    tracer.clear();
+    embedder.execute(0u);
+    QVERIFY(tracer.spans().empty());
+}
+
+
+void SerialScriptEmbedderTest::flightRecorderTest()
+{
+    using namespace ScriptEmbedderNS;
+    // Initialize embedder.
+    Configuration conf;
+    conf.setScriptAPI(std::shared_ptr<ScriptAPI>(new ScriptAPI()));
+    conf.addInterpreter(InterpreterEntry("TestLanguage", PLUGIN_PATH));
+    conf.addScript(ScriptEntry(0u, TEST_PATH+"testscript.txt", "TestLanguage", true, 0u));
+    SerialScriptEmbedder embedder(conf);
+    QVERIFY(embedder.isValid());
+    QVERIFY(embedder.flightRecorder().entries().empty());
+
+    // Initialize plugin
+    QPluginLoader loader(PLUGIN_PATH);
+    InterpreterTestPlugin* plugin = ((InterpreterTestPlugin*)loader.instance());
+    loader.unload();
+    plugin->result.result = ScriptInterpreter::SUCCESS;
+    plugin->result.returnValue = 0;
+
+    QStringList params{"a", "b"};
+    embedder.execute(0u, params);
+    embedder.execute(3u); // No such script.
+
+    std::vector<FlightRecorder::Entry> entries = embedder.flightRecorder().entries();
+    QVERIFY(entries.size() == 2);
+    QCOMPARE(entries.at(0).scriptId, 0u);
+    QCOMPARE(entries.at(0).paramsHash, qHash(params));
+    QVERIFY(entries.at(0).status == ScriptInterpreter::SUCCESS);
+    QVERIFY(entries.at(0).interpreter != 0);
+    QVERIFY(entries.at(0).duration >= 0);
+    QCOMPARE(entries.at(1).scriptId, 3u);
+    QVERIFY(entries.at(1).errorCode == ScriptResultRecord::NO_SUCH_SCRIPT);
+    QCOMPARE(entries.at(1).interpreter, quintptr(0));
+}
+
+
+bool SerialScriptEmbedderTest::write(const QString& path, const QByteArray& contents) const
+{
+    QFile f(path);
+    if (!f.open(QFile::WriteOnly | QFile::Truncate)) return false;
+    return f.write(contents) == contents.size();
+}
+
+
+ScriptMap SerialScriptEmbedderTest::fileScripts(const QTemporaryDir& dir,
+                                                const QList<QByteArray>& sources) const
+{
+    // Script i is read on demand from file "i.txt". Empty map on failure.
+    ScriptMap scripts;
+    for (int i = 0; i < sources.size(); ++i) {
+        QString path = dir.path() + QString("/%1.txt").arg(i);
+        if (!this->write(path, sources.at(i))) return ScriptMap();
+        scripts[unsigned(i)] = ScriptEmbedderNS::ScriptEntry(unsigned(i), path, "TestLanguage");
+    }
+    return scripts;
+}
+
+
+ScriptEmbedderNS::Configuration SerialScriptEmbedderTest::testConfiguration(const ScriptMap& scripts) const
+{
+    using namespace ScriptEmbedderNS;
+    std::shared_ptr<ScriptAPI> api(new ScriptAPI());
+    InterpreterMap interpreters {{"TestLanguage", InterpreterEntry("TestLanguage", PLUGIN_PATH)}};
+    return Configuration(api, interpreters, scripts);
+}
+
+
+InterpreterTestPlugin* SerialScriptEmbedderTest::testPlugin() const
+{
+    // Plugin stays loaded by the embedder created before this call.
+    QPluginLoader loader(PLUGIN_PATH);
+    InterpreterTestPlugin* plugin = ((InterpreterTestPlugin*)loader.instance());
+    loader.unload();
+    plugin->result.result = ScriptEmbedderNS::ScriptInterpreter::SUCCESS;
+    plugin->result.returnValue = 0;
+    return plugin;
 }
 
 
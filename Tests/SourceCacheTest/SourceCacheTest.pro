@@ -0,0 +1,24 @@
+#-------------------------------------------------
+#
+# Project created by QtCreator 2016-07-01T18:05:51
+#
+#-------------------------------------------------
+
+QT       += testlib
+
+QT       -= gui
+
+TARGET = tst_sourcecachetest
+CONFIG   += console c++11
+CONFIG   -= app_bundle
+
+TEMPLATE = app
+
+INCLUDEPATH += \
+    ../../ScriptEmbedder/include \
+    ../../ScriptEmbedder/src
+
+SOURCES += tst_sourcecachetest.cc \
+           ../../ScriptEmbedder/src/sourcecache.cc
+
+DEFINES += SRCDIR=\\\"$$PWD/\\\"
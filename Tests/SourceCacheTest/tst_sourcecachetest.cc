@@ -0,0 +1,109 @@
+/**
+ * @file
+ * @brief Unit tests for the SourceCache class.
+ * @author Perttu Paarlahti 2016.
+ */
+
+#include <QString>
+#include <QtTest>
+#include "sourcecache.hh"
+
+
+/**
+ * @brief Unit tests for the SourceCache class.
+ */
+class SourceCacheTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    SourceCacheTest();
+
+private Q_SLOTS:
+
+    /**
+     * @brief Test inserting, finding and removing sources.
+     */
+    void findTest();
+
+    /**
+     * @brief Test evicting least recently used sources.
+     */
+    void evictionTest();
+};
+
+
+SourceCacheTest::SourceCacheTest()
+{
+}
+
+
+void SourceCacheTest::findTest()
+{
+    using namespace ScriptEmbedderNS;
+    SourceCache cache(1000);
+    QByteArray utf8;
+    QString text;
+    QVERIFY(!cache.find("0", utf8));
+    QVERIFY(!cache.find("0", text));
+
+    cache.insert("0", QByteArray("abc"));
+    cache.insert("1", QString("abcd"));
+    QCOMPARE(cache.size(), qint64(3 + 8));
+    QVERIFY(cache.find("0", utf8));
+    QCOMPARE(utf8, QByteArray("abc"));
+    QVERIFY(!cache.find("0", text));
+    QVERIFY(cache.find("1", text));
+    QCOMPARE(text, QString("abcd"));
+    QVERIFY(!cache.find("1", utf8));
+
+    // Replace with other encoding.
+    cache.insert("0", QString("x"));
+    QCOMPARE(cache.size(), qint64(2 + 8));
+    QVERIFY(!cache.find("0", utf8));
+    QVERIFY(cache.find("0", text));
+
+    cache.remove("0");
+    QVERIFY(!cache.find("0", text));
+    QCOMPARE(cache.size(), qint64(8));
+    cache.remove("5");
+
+    cache.clear();
+    QCOMPARE(cache.size(), qint64(0));
+    QVERIFY(!cache.find("1", text));
+}
+
+
+void SourceCacheTest::evictionTest()
+{
+    using namespace ScriptEmbedderNS;
+    SourceCache cache(10);
+    QByteArray source;
+    cache.insert("0", QByteArray(4, 'a'));
+    cache.insert("1", QByteArray(4, 'b'));
+
+    // Using 0 makes 1 the least recently used.
+    QVERIFY(cache.find("0", source));
+    cache.insert("2", QByteArray(4, 'c'));
+    QCOMPARE(cache.size(), qint64(8));
+    QVERIFY(cache.find("0", source));
+    QVERIFY(!cache.find("1", source));
+    QVERIFY(cache.find("2", source));
+
+    // Too large source is not cached and does not evict others.
+    cache.insert("3", QByteArray(11, 'd'));
+    QVERIFY(!cache.find("3", source));
+    QCOMPARE(cache.size(), qint64(8));
+
+    // Source filling whole capacity evicts all others.
+    cache.insert("4", QByteArray(10, 'e'));
+    QCOMPARE(cache.size(), qint64(10));
+    QVERIFY(!cache.find("0", source));
+    QVERIFY(!cache.find("2", source));
+    QVERIFY(cache.find("4", source));
+}
+
+
+QTEST_APPLESS_MAIN(SourceCacheTest)
+
+#include "tst_sourcecachetest.moc"
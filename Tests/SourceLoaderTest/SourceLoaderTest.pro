@@ -0,0 +1,24 @@
+#-------------------------------------------------
+#
+# Project created by QtCreator 2016-07-04T20:11:37
+#
+#-------------------------------------------------
+
+QT       += testlib
+
+QT       -= gui
+
+TARGET = tst_sourceloadertest
+CONFIG   += console c++11
+CONFIG   -= app_bundle
+
+TEMPLATE = app
+
+INCLUDEPATH += \
+    ../../ScriptEmbedder/include \
+    ../../ScriptEmbedder/src
+
+SOURCES += tst_sourceloadertest.cc \
+           ../../ScriptEmbedder/src/sourceloader.cc
+
+DEFINES += SRCDIR=\\\"$$PWD/\\\"
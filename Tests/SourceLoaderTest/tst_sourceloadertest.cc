@@ -0,0 +1,179 @@
+/**
+ * @file
+ * @brief Unit tests for the SourceLoader class.
+ * @author Perttu Paarlahti 2016.
+ */
+
+#include <QString>
+#include <QtTest>
+#include <QTemporaryDir>
+#include "sourceloader.hh"
+
+
+/**
+ * @brief Unit tests for the SourceLoader class.
+ */
+class SourceLoaderTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    SourceLoaderTest();
+
+private Q_SLOTS:
+
+    /**
+     * @brief Test requesting and taking sources.
+     */
+    void takeTest();
+
+    /**
+     * @brief Test cancelling, replacing and dropping requests.
+     */
+    void cancelTest();
+
+    /**
+     * @brief Test that old requests are not used.
+     */
+    void expiryTest();
+
+
+private:
+
+    QTemporaryDir dir_;
+
+    QString createFile(const QString& name, const QByteArray& contents) const;
+    bool waitLoaded(const ScriptEmbedderNS::SourceLoader& loader, std::size_t count) const;
+};
+
+
+SourceLoaderTest::SourceLoaderTest() :
+    dir_()
+{
+}
+
+
+void SourceLoaderTest::takeTest()
+{
+    using namespace ScriptEmbedderNS;
+    QVERIFY(dir_.isValid());
+    QString a = this->createFile("a.txt", "source a");
+    QString b = this->createFile("b.txt", "source b");
+
+    SourceLoader loader(2u, 8u, 60000);
+    QByteArray contents("unchanged");
+    QVERIFY(!loader.take(0u, contents));
+    QCOMPARE(contents, QByteArray("unchanged"));
+
+    loader.request(0u, a);
+    loader.request(1u, b);
+    loader.request(2u, dir_.path() + "/missing.txt");
+    QCOMPARE(loader.pending(), std::size_t(3));
+    QVERIFY(this->waitLoaded(loader, 3u));
+
+    QVERIFY(loader.take(1u, contents));
+    QCOMPARE(contents, QByteArray("source b"));
+    QVERIFY(loader.take(0u, contents));
+    QCOMPARE(contents, QByteArray("source a"));
+    QVERIFY(loader.take(2u, contents));
+    QVERIFY(contents.isEmpty());
+    QCOMPARE(loader.pending(), std::size_t(0));
+
+    // Taken request is removed.
+    QVERIFY(!loader.take(0u, contents));
+
+    // Request not started yet is dropped, so that caller reads the file.
+    SourceLoader busy(1u, 64u, 60000);
+    for (unsigned id = 0; id < 64; ++id) {
+        busy.request(id, a);
+    }
+    QVERIFY(!busy.take(63u, contents));
+    QCOMPARE(busy.pending(), std::size_t(63));
+}
+
+
+void SourceLoaderTest::cancelTest()
+{
+    using namespace ScriptEmbedderNS;
+    QVERIFY(dir_.isValid());
+    QString a = this->createFile("a.txt", "source a");
+    QString b = this->createFile("b.txt", "source b");
+
+    SourceLoader loader(1u, 2u, 60000);
+    QByteArray contents;
+    loader.request(0u, a);
+    loader.cancel(0u);
+    loader.cancel(5u);
+    QVERIFY(!loader.take(0u, contents));
+
+    // Replaced request reads the new path.
+    loader.request(0u, a);
+    loader.request(0u, b);
+    QCOMPARE(loader.pending(), std::size_t(1));
+    QVERIFY(this->waitLoaded(loader, 1u));
+    QVERIFY(loader.take(0u, contents));
+    QCOMPARE(contents, QByteArray("source b"));
+
+    // Oldest request is dropped when full.
+    loader.request(0u, a);
+    loader.request(1u, a);
+    loader.request(2u, b);
+    QCOMPARE(loader.pending(), std::size_t(2));
+    QVERIFY(!loader.take(0u, contents));
+    QVERIFY(this->waitLoaded(loader, 2u));
+    QVERIFY(loader.take(2u, contents));
+    QCOMPARE(contents, QByteArray("source b"));
+
+    loader.clear();
+    QCOMPARE(loader.pending(), std::size_t(0));
+    QVERIFY(!loader.take(1u, contents));
+}
+
+
+void SourceLoaderTest::expiryTest()
+{
+    using namespace ScriptEmbedderNS;
+    QVERIFY(dir_.isValid());
+    QString a = this->createFile("a.txt", "source a");
+
+    SourceLoader loader(1u, 2u, 200);
+    QByteArray contents;
+    loader.request(0u, a);
+    QTest::qSleep(300);
+    QVERIFY(!loader.take(0u, contents));
+    QCOMPARE(loader.pending(), std::size_t(0));
+
+    // Repeated request renews an old one.
+    loader.request(0u, a);
+    QTest::qSleep(300);
+    loader.request(0u, a);
+    QVERIFY(this->waitLoaded(loader, 1u));
+    QVERIFY(loader.take(0u, contents));
+    QCOMPARE(contents, QByteArray("source a"));
+}
+
+
+QString SourceLoaderTest::createFile(const QString& name, const QByteArray& contents) const
+{
+    QString path = dir_.path() + "/" + name;
+    QFile f(path);
+    if (f.open(QFile::WriteOnly | QFile::Truncate)) {
+        f.write(contents);
+    }
+    return path;
+}
+
+
+bool SourceLoaderTest::waitLoaded(const ScriptEmbedderNS::SourceLoader& loader,
+                                  std::size_t count) const
+{
+    for (int i = 0; i < 500 && loader.loaded() < count; ++i) {
+        QTest::qSleep(10);
+    }
+    return loader.loaded() == count;
+}
+
+
+QTEST_APPLESS_MAIN(SourceLoaderTest)
+
+#include "tst_sourceloadertest.moc"
@@ -0,0 +1,26 @@
+#-------------------------------------------------
+#
+# Project created by QtCreator 2016-07-06T19:02:45
+#
+#-------------------------------------------------
+
+QT       += testlib
+
+QT       -= gui
+
+TARGET = tst_sourcepooltest
+CONFIG   += console c++11
+CONFIG   -= app_bundle
+
+TEMPLATE = app
+
+INCLUDEPATH += \
+    ../../ScriptEmbedder/include \
+    ../../ScriptEmbedder/src
+
+SOURCES += tst_sourcepooltest.cc \
+           ../../ScriptEmbedder/src/sourcepool.cc \
+           ../../ScriptEmbedder/src/scriptsource.cc \
+           ../../ScriptEmbedder/src/configuration.cc
+
+DEFINES += SRCDIR=\\\"$$PWD/\\\"
@@ -0,0 +1,118 @@
+/**
+ * @file
+ * @brief Unit tests for the SourcePool class.
+ * @author Perttu Paarlahti 2016.
+ */
+
+#include <QString>
+#include <QtTest>
+#include "sourcepool.hh"
+
+
+/**
+ * @brief Unit tests for the SourcePool class.
+ */
+class SourcePoolTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    SourcePoolTest();
+
+private Q_SLOTS:
+
+    /**
+     * @brief Test sharing identical sources.
+     */
+    void internTest();
+
+    /**
+     * @brief Test that released sources are not returned.
+     */
+    void releaseTest();
+
+
+private:
+
+    std::shared_ptr<ScriptEmbedderNS::ScriptSource> create(
+            const QString& source,
+            bool utf8 = false,
+            ScriptEmbedderNS::ScriptEntry::Storage storage =
+            ScriptEmbedderNS::ScriptEntry::COPY) const;
+};
+
+
+SourcePoolTest::SourcePoolTest()
+{
+}
+
+
+void SourcePoolTest::internTest()
+{
+    using namespace ScriptEmbedderNS;
+    SourcePool pool;
+    std::shared_ptr<ScriptSource> a = this->create("source a");
+    QVERIFY(pool.intern(a) == a);
+    QCOMPARE(pool.size(), std::size_t(1));
+
+    // Identical source is shared.
+    std::shared_ptr<ScriptSource> copy = this->create("source a");
+    QVERIFY(copy != a);
+    QVERIFY(copy->hash() == a->hash());
+    QVERIFY(pool.intern(copy) == a);
+    QCOMPARE(pool.size(), std::size_t(1));
+
+    // Different contents or storage are not shared.
+    std::shared_ptr<ScriptSource> b = this->create("source b");
+    std::shared_ptr<ScriptSource> utf8 = this->create("source a", true);
+    std::shared_ptr<ScriptSource> compressed = this->create("source a", false,
+                                                            ScriptEntry::COMPRESSED);
+    QVERIFY(pool.intern(b) == b);
+    QVERIFY(pool.intern(utf8) == utf8);
+    QVERIFY(pool.intern(compressed) == compressed);
+    QCOMPARE(pool.size(), std::size_t(4));
+    QVERIFY(pool.intern(this->create("source a", false, ScriptEntry::COMPRESSED)) == compressed);
+
+    pool.clear();
+    QCOMPARE(pool.size(), std::size_t(0));
+    QVERIFY(pool.intern(copy) == copy);
+}
+
+
+void SourcePoolTest::releaseTest()
+{
+    using namespace ScriptEmbedderNS;
+    SourcePool pool;
+    std::shared_ptr<ScriptSource> a = pool.intern(this->create("source a"));
+    std::weak_ptr<ScriptSource> released = a;
+    a.reset();
+    QVERIFY(released.expired());
+    QCOMPARE(pool.size(), std::size_t(0));
+
+    std::shared_ptr<ScriptSource> again = this->create("source a");
+    QVERIFY(pool.intern(again) == again);
+    QCOMPARE(pool.size(), std::size_t(1));
+
+    // Released sources are pruned as the pool grows.
+    for (int i = 0; i < 1000; ++i) {
+        pool.intern(this->create(QString("source %1").arg(i)));
+    }
+    QCOMPARE(pool.size(), std::size_t(1));
+    QVERIFY(pool.intern(this->create("source a")) == again);
+}
+
+
+std::shared_ptr<ScriptEmbedderNS::ScriptSource> SourcePoolTest::create(
+        const QString& source,
+        bool utf8,
+        ScriptEmbedderNS::ScriptEntry::Storage storage) const
+{
+    using namespace ScriptEmbedderNS;
+    return ScriptSource::create(ScriptEntry::fromSource(0u, source, "Python", 0u,
+                                                        QString(), storage), utf8);
+}
+
+
+QTEST_APPLESS_MAIN(SourcePoolTest)
+
+#include "tst_sourcepooltest.moc"
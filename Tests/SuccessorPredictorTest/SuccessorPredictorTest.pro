@@ -0,0 +1,24 @@
+#-------------------------------------------------
+#
+# Project created by QtCreator 2016-07-08T20:14:31
+#
+#-------------------------------------------------
+
+QT       += testlib
+
+QT       -= gui
+
+TARGET = tst_successorpredictortest
+CONFIG   += console c++11
+CONFIG   -= app_bundle
+
+TEMPLATE = app
+
+INCLUDEPATH += \
+    ../../ScriptEmbedder/include \
+    ../../ScriptEmbedder/src
+
+SOURCES += tst_successorpredictortest.cc \
+           ../../ScriptEmbedder/src/successorpredictor.cc
+
+DEFINES += SRCDIR=\\\"$$PWD/\\\"
@@ -0,0 +1,167 @@
+/**
+ * @file
+ * @brief Unit tests for the SuccessorPredictor class.
+ * @author Perttu Paarlahti 2016.
+ */
+
+#include <QString>
+#include <QtTest>
+#include <algorithm>
+#include "successorpredictor.hh"
+
+
+/**
+ * @brief Unit tests for the SuccessorPredictor class.
+ */
+class SuccessorPredictorTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    SuccessorPredictorTest();
+
+private Q_SLOTS:
+
+    /**
+     * @brief Test predicting direct and indirect successors.
+     */
+    void predictTest();
+
+    /**
+     * @brief Test that executions far apart are not successors.
+     */
+    void windowTest();
+
+    /**
+     * @brief Test forgetting history.
+     */
+    void forgetTest();
+
+    /**
+     * @brief Test that predictions follow changed execution patterns.
+     */
+    void changeTest();
+};
+
+
+SuccessorPredictorTest::SuccessorPredictorTest()
+{
+}
+
+
+void SuccessorPredictorTest::predictTest()
+{
+    using namespace ScriptEmbedderNS;
+    SuccessorPredictor predictor(100);
+    QVERIFY(predictor.predict(0u).empty());
+
+    // Chain 0 -> 1 -> 2, executed repeatedly.
+    qint64 time = 0;
+    for (int i = 0; i < 10; ++i) {
+        predictor.record(0u, time);
+        predictor.record(1u, time + 10);
+        predictor.record(2u, time + 20);
+        time += 1000;
+    }
+    std::vector<unsigned> next = predictor.predict(0u);
+    QCOMPARE(next.size(), std::size_t(2));
+    QCOMPARE(next[0], 1u);
+    QCOMPARE(next[1], 2u);
+    next = predictor.predict(1u);
+    QCOMPARE(next.size(), std::size_t(1));
+    QCOMPARE(next[0], 2u);
+    QVERIFY(predictor.predict(2u).empty());
+
+    // Rare successor is not predicted.
+    predictor.record(0u, time);
+    predictor.record(3u, time + 10);
+    next = predictor.predict(0u);
+    QVERIFY(std::find(next.begin(), next.end(), 3u) == next.end());
+}
+
+
+void SuccessorPredictorTest::windowTest()
+{
+    using namespace ScriptEmbedderNS;
+    SuccessorPredictor predictor(100);
+    qint64 time = 0;
+    for (int i = 0; i < 10; ++i) {
+        predictor.record(0u, time);
+        predictor.record(1u, time + 500);
+        time += 1000;
+    }
+    QVERIFY(predictor.predict(0u).empty());
+    QVERIFY(predictor.predict(1u).empty());
+
+    // Repeated execution of the same script is not a successor.
+    predictor.record(4u, time);
+    predictor.record(4u, time + 1);
+    QVERIFY(predictor.predict(4u).empty());
+}
+
+
+void SuccessorPredictorTest::forgetTest()
+{
+    using namespace ScriptEmbedderNS;
+    SuccessorPredictor predictor(100);
+    qint64 time = 0;
+    for (int i = 0; i < 10; ++i) {
+        predictor.record(0u, time);
+        predictor.record(1u, time + 10);
+        predictor.record(2u, time + 20);
+        time += 1000;
+    }
+
+    predictor.forget(1u);
+    QVERIFY(predictor.predict(0u).empty());
+    QVERIFY(predictor.predict(1u).empty());
+
+    // Forgotten script does not become predecessor of the next one.
+    predictor.record(2u, time);
+    predictor.forget(2u);
+    predictor.record(5u, time + 10);
+    QVERIFY(predictor.predict(2u).empty());
+
+    predictor.record(5u, time + 1000);
+    predictor.record(6u, time + 1010);
+    QCOMPARE(predictor.predict(5u).size(), std::size_t(1));
+    predictor.clear();
+    QVERIFY(predictor.predict(5u).empty());
+}
+
+
+void SuccessorPredictorTest::changeTest()
+{
+    using namespace ScriptEmbedderNS;
+    SuccessorPredictor predictor(100);
+    qint64 time = 0;
+    for (int i = 0; i < 1000; ++i) {
+        predictor.record(0u, time);
+        predictor.record(1u, time + 10);
+        time += 1000;
+    }
+    // Old counts decay, so that new successor takes over.
+    for (int i = 0; i < 1000; ++i) {
+        predictor.record(0u, time);
+        predictor.record(2u, time + 10);
+        time += 1000;
+    }
+    std::vector<unsigned> next = predictor.predict(0u);
+    QCOMPARE(next.size(), std::size_t(1));
+    QCOMPARE(next[0], 2u);
+
+    // Many rare successors replace each other, not the frequent one.
+    for (unsigned id = 100; id < 200; ++id) {
+        predictor.record(0u, time);
+        predictor.record(id, time + 10);
+        time += 1000;
+    }
+    next = predictor.predict(0u);
+    QCOMPARE(next.size(), std::size_t(1));
+    QCOMPARE(next[0], 2u);
+}
+
+
+QTEST_APPLESS_MAIN(SuccessorPredictorTest)
+
+#include "tst_successorpredictortest.moc"
@@ -3,4 +3,18 @@ TEMPLATE = subdirs
 SUBDIRS += \
     ConfigurationTest \
     InterpreterLoaderTest \
-    SerialScriptEmbedderTest
+    SerialScriptEmbedderTest \
+    AsyncLoggerTest \
+    ExecutionTracerTest \
+    FlightRecorderTest \
+    ExecutionTraceTest \
+    ConfigurationFileTest \
+    SourceCacheTest \
+    FileStampTest \
+    SourceLoaderTest \
+    SourcePoolTest \
+    SuccessorPredictorTest \
+    Benchmarks
+
+# Benchmarks use the test plugin built in SerialScriptEmbedderTest.
+Benchmarks.depends = SerialScriptEmbedderTest
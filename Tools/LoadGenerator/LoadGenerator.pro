@@ -0,0 +1,24 @@
+#-------------------------------------------------
+#
+# Project created by QtCreator 2016-06-26T15:32:08
+#
+#-------------------------------------------------
+
+QT       += core
+
+QT       -= gui
+
+TARGET = LoadGenerator
+CONFIG   += console c++11
+CONFIG   -= app_bundle
+
+TEMPLATE = app
+
+win32:CONFIG(release, debug|release): LIBS += -L$$OUT_PWD/../../ScriptEmbedder/release/ -lScriptEmbedder
+else:win32:CONFIG(debug, debug|release): LIBS += -L$$OUT_PWD/../../ScriptEmbedder/debug/ -lScriptEmbedder
+else:unix: LIBS += -L$$OUT_PWD/../../ScriptEmbedder/ -lScriptEmbedder
+
+INCLUDEPATH += \
+    ../../ScriptEmbedder/include
+
+SOURCES += main.cc
@@ -0,0 +1,269 @@
+/**
+ * @file
+ * @brief Command-line load generator that replays execution traces against
+ * a ScriptEmbedder and reports throughput and latency percentiles.
+ * Traces are recorded from a live application with
+ * ScriptEmbedderBuilder::createRecordingEmbedder().
+ *
+ * Example:
+ *   LoadGenerator -i QtScript=plugins/libQtScriptPluginExample.so \
+ *                 -s 0=QtScript:scripts/hello.qs --speed 4 trace.bin
+ * @author Perttu Paarlahti 2016.
+ */
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QTextStream>
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "scriptembedderbuilder.hh"
+#include "executiontrace.hh"
+#include "configurationfile.hh"
+
+
+namespace
+{
+
+/**
+ * @brief Replay settings given on the command line.
+ */
+struct Options
+{
+    ScriptEmbedderNS::Configuration configuration;
+    QString mode;
+    QString tracePath;
+    double speed;       // 0 means as fast as possible.
+};
+
+
+/**
+ * @brief Parse command line.
+ * @param app Application.
+ * @param options Receives the parsed options.
+ * @param errorMsg Receives error message if parsing fails.
+ * @return True, if command line was valid.
+ */
+bool parseOptions(const QCoreApplication& app, Options& options, QString& errorMsg)
+{
+    using namespace ScriptEmbedderNS;
+    QCommandLineParser parser;
+    parser.setApplicationDescription(
+                "Replays an execution trace against a ScriptEmbedder and reports "
+                "throughput and latency percentiles. Scripts see an empty ScriptAPI.");
+    parser.addHelpOption();
+    parser.addPositionalArgument("trace", "Execution trace to replay.");
+    QCommandLineOption interpreterOption(
+                QStringList() << "i" << "interpreter",
+                "Interpreter plugin for a language. May be repeated.",
+                "language=plugin");
+    QCommandLineOption scriptOption(
+                QStringList() << "s" << "script",
+                "Script to be executed. May be repeated.",
+                "id=language:path");
+    QCommandLineOption configOption(
+                QStringList() << "c" << "config",
+                "Configuration file, either JSON (.json) or binary. Interpreters and "
+                "scripts given with -i and -s are added to it.", "file");
+    QCommandLineOption ramOption(
+                "ram", "Read scripts into RAM instead of loading them on demand.");
+    QCommandLineOption speedOption(
+                "speed", "Replay speed: 1 for original timing, N for N times faster, "
+                "or 'max' for no delays.", "speed", "1");
+    QCommandLineOption modeOption(
+                "mode", "Embedder mode. Supported modes: serial.", "mode", "serial");
+    parser.addOption(configOption);
+    parser.addOption(interpreterOption);
+    parser.addOption(scriptOption);
+    parser.addOption(ramOption);
+    parser.addOption(speedOption);
+    parser.addOption(modeOption);
+    parser.process(app);
+
+    if (parser.positionalArguments().size() != 1) {
+        errorMsg = "Exactly one trace file must be given.";
+        return false;
+    }
+    options.tracePath = parser.positionalArguments().at(0);
+
+    options.mode = parser.value(modeOption);
+    if (options.mode != "serial") {
+        errorMsg = QString("Unknown embedder mode '%1'.").arg(options.mode);
+        return false;
+    }
+
+    QString speed = parser.value(speedOption);
+    bool ok = true;
+    options.speed = speed == "max" ? 0.0 : speed.toDouble(&ok);
+    if (!ok || options.speed < 0.0) {
+        errorMsg = QString("Invalid speed '%1'.").arg(speed);
+        return false;
+    }
+
+    Configuration& conf = options.configuration;
+    conf.setScriptAPI(std::shared_ptr<ScriptAPI>(new ScriptAPI()));
+    if (parser.isSet(configOption)) {
+        QString path = parser.value(configOption);
+        ConfigurationFile file;
+        if (path.endsWith(".json")) {
+            QFile f(path);
+            if (!f.open(QFile::ReadOnly)) {
+                errorMsg = QString("Could not open '%1': %2").arg(path).arg(f.errorString());
+                return false;
+            }
+            ok = file.fromJson(f.readAll(), conf);
+        }
+        else if ((ok = file.open(path))) {
+            conf = file.toConfiguration(conf.scriptAPI());
+        }
+        if (!ok) {
+            errorMsg = file.errorString();
+            return false;
+        }
+    }
+    foreach (const QString& value, parser.values(interpreterOption)) {
+        int separator = value.indexOf('=');
+        if (separator <= 0) {
+            errorMsg = QString("Invalid interpreter '%1'.").arg(value);
+            return false;
+        }
+        conf.addInterpreter(InterpreterEntry(value.left(separator), value.mid(separator+1)));
+    }
+    foreach (const QString& value, parser.values(scriptOption)) {
+        int idEnd = value.indexOf('=');
+        int languageEnd = value.indexOf(':', idEnd+1);
+        unsigned id = value.left(idEnd).toUInt(&ok);
+        if (idEnd <= 0 || languageEnd <= idEnd+1 || !ok) {
+            errorMsg = QString("Invalid script '%1'.").arg(value);
+            return false;
+        }
+        conf.addScript(ScriptEntry(id, value.mid(languageEnd+1),
+                                   value.mid(idEnd+1, languageEnd-idEnd-1),
+                                   parser.isSet(ramOption)));
+    }
+
+    ValidationReport report = conf.validate();
+    if (!report.isValid()) {
+        errorMsg = report.errorString();
+        return false;
+    }
+    return true;
+}
+
+
+/**
+ * @brief Get percentile of sorted values.
+ * @param sorted Values in ascending order.
+ * @param p Percentile between 0 and 1.
+ * @return Value at the percentile, or 0 if there are no values.
+ */
+qint64 percentile(const std::vector<qint64>& sorted, double p)
+{
+    if (sorted.empty()) return 0;
+
+    std::size_t index = std::size_t(p * double(sorted.size() - 1) + 0.5);
+    return sorted[index];
+}
+
+} // namespace
+
+
+/**
+ * @brief Load generator.
+ */
+int main(int argc, char* argv[])
+{
+    using namespace ScriptEmbedderNS;
+    QCoreApplication app(argc, argv);
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    Options options;
+    QString errorMsg;
+    if (!parseOptions(app, options, errorMsg)) {
+        err << errorMsg << endl;
+        return 1;
+    }
+
+    // Read the whole trace before replaying, so that replay does no file I/O.
+    ExecutionTraceReader reader;
+    if (!reader.open(options.tracePath)) {
+        err << reader.errorString() << endl;
+        return 1;
+    }
+    std::vector<TraceEvent> events;
+    TraceEvent event;
+    while (reader.next(event)) {
+        events.push_back(event);
+    }
+    if (!reader.errorString().isEmpty()) {
+        err << reader.errorString() << endl;
+        return 1;
+    }
+    if (events.empty()) {
+        err << "Trace is empty." << endl;
+        return 1;
+    }
+
+    std::unique_ptr<ScriptEmbedder> embedder(
+                ScriptEmbedderBuilder::createSerialEmbedder(options.configuration));
+    if (!embedder->isValid()) {
+        err << embedder->errorString() << endl;
+        return 1;
+    }
+
+    // Replay.
+    std::vector<qint64> latencies;
+    latencies.reserve(events.size());
+    qint64 maxLag = 0;
+    qint64 origin = events.front().timestamp;
+    QElapsedTimer clock;
+    clock.start();
+    for (auto it = events.begin(); it != events.end(); ++it) {
+        if (options.speed > 0.0) {
+            qint64 due = qint64(double(it->timestamp - origin) / options.speed);
+            qint64 wait = due - clock.nsecsElapsed();
+            if (wait > 0) {
+                std::this_thread::sleep_for(std::chrono::nanoseconds(wait));
+            }
+            maxLag = qMax(maxLag, clock.nsecsElapsed() - due);
+        }
+
+        qint64 begin = clock.nsecsElapsed();
+        embedder->execute(it->scriptId, it->params);
+        latencies.push_back(clock.nsecsElapsed() - begin);
+    }
+    qint64 elapsed = clock.nsecsElapsed();
+
+    // Report. Failed executions of unknown scripts are not included in
+    // metrics, so they are counted from the trace.
+    quint64 failures = 0;
+    for (auto it = events.begin(); it != events.end(); ++it) {
+        if (!options.configuration.hasScript(it->scriptId)) {
+            ++failures;
+        }
+    }
+    MetricsSnapshot metrics = embedder->metrics();
+    for (auto it = metrics.languages.begin(); it != metrics.languages.end(); ++it) {
+        failures += it->second.failures;
+    }
+    std::sort(latencies.begin(), latencies.end());
+
+    out << "Mode:        " << options.mode << endl;
+    out << "Executions:  " << events.size() << " (" << failures << " failed)" << endl;
+    out << "Elapsed:     " << double(elapsed) / 1e6 << " ms" << endl;
+    out << "Throughput:  " << double(events.size()) * 1e9 / double(qMax(elapsed, qint64(1)))
+        << " executions/s" << endl;
+    out << "Latency p50: " << double(percentile(latencies, 0.5)) / 1e3 << " us" << endl;
+    out << "Latency p99: " << double(percentile(latencies, 0.99)) / 1e3 << " us" << endl;
+    out << "Latency p99.9: " << double(percentile(latencies, 0.999)) / 1e3 << " us" << endl;
+    out << "Latency max: " << double(latencies.back()) / 1e3 << " us" << endl;
+    if (options.speed > 0.0) {
+        out << "Max lag behind schedule: " << double(maxLag) / 1e3 << " us" << endl;
+    }
+    return 0;
+}